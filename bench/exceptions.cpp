@@ -0,0 +1,125 @@
+/**
+ * =============================================================================
+ * bench/exceptions.cpp
+ *
+ * C++ exception bridge (ERRCHECK_ENABLE_EXCEPTIONS) versus return codes
+ * through a call stack DEPTH frames deep, across failure rates. In the
+ * return-code variant every frame tests its callee's err_t; in the exception
+ * variant the layers are void, the leaf CHECK throws and one boundary on top
+ * turns the errcheck_error back into ERR_FAILURE / g_last_error.
+ *
+ *   g++ -O2 -std=c++11 exceptions.cpp -o exceptions && ./exceptions
+ *
+ * The exception success path has no per-frame test; a throw costs the
+ * allocation plus a two-phase table-driven unwind, orders of magnitude more
+ * than DEPTH returns. Measured (gcc 12, x86-64, -O2, glibc, DEPTH=16;
+ * noisy machine, run-to-run spread up to 20 %):
+ *
+ *     failure rate       return codes ns/call   exceptions ns/call
+ *     0                              51-58                22-24
+ *     0.01 %                         44-50                22-29
+ *     0.1 %                          40-53                25-34
+ *     1 %                            40-49                65-81
+ *     10 %                           45-52              510-610
+ *
+ * Break-even is around 0.3 % on this machine; keep the bridge for errors
+ * that are truly exceptional.
+ * =============================================================================
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+typedef enum {
+    ERR_NONE = 0,
+    ERR_FIELD,
+    ERR_MESSAGE
+} err_t;
+#define ERR_T
+
+#define ERR_FAILURE ((err_t)0xFF)
+
+err_t g_last_error = ERR_NONE;
+
+#define ERRCHECK_ENABLE_EXCEPTIONS
+#include "../errcheck.h"
+
+#define ITERATIONS 10000000L
+#define DEPTH      16
+
+/* Opaque leaf: validates one field (0 = bad) */
+__attribute__((noinline)) int field_ok(long v) { __asm__ volatile(""); return v != 0; }
+
+/* ------------------------------------------------------------------------- */
+/* Return codes: every frame tests its callee (CHECK without the bridge)    */
+/* ------------------------------------------------------------------------- */
+__attribute__((noinline)) err_t rc_layer(long v, int depth)
+{
+    if (depth == 0) {
+        if (!field_ok(v)) { g_last_error = ERR_FIELD; return ERR_FAILURE; }
+        return ERR_NONE;
+    }
+    if (rc_layer(v, depth - 1) != ERR_NONE) { g_last_error = ERR_FIELD; return ERR_FAILURE; }
+    return ERR_NONE;
+}
+
+__attribute__((noinline)) err_t rc_message(long v)
+{
+    if (rc_layer(v, DEPTH - 1) != ERR_NONE) { g_last_error = ERR_MESSAGE; return ERR_FAILURE; }
+    return ERR_NONE;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Exceptions: void layers, one boundary on top                              */
+/* ------------------------------------------------------------------------- */
+__attribute__((noinline)) void exc_layer(long v, int depth)
+{
+    if (depth == 0) {
+        CHECK_VOID(field_ok(v), ERR_FIELD);
+        return;
+    }
+    exc_layer(v, depth - 1);
+    __asm__ volatile("");                   /* keep the frame: no tail call */
+}
+
+__attribute__((noinline)) err_t exc_message(long v)
+{
+    ERRCHECK_BOUNDARY_BEGIN
+        exc_layer(v, DEPTH - 1);
+        return ERR_NONE;
+    ERRCHECK_BOUNDARY_END(ERR_FAILURE)
+}
+
+/* ------------------------------------------------------------------------- */
+/* 'period' = one failure every period calls; 0 = never                      */
+static double run(err_t (*fn)(long), long period)
+{
+    struct timespec a, b;
+    long i, failed = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    for (i = 0; i < ITERATIONS; i++) failed += fn(period && i % period == 0 ? 0 : i + 1) != ERR_NONE;
+    clock_gettime(CLOCK_MONOTONIC, &b);
+
+    if (failed != (period ? (ITERATIONS + period - 1) / period : 0))
+        printf("unexpected result count %ld\n", failed);
+    return ((b.tv_sec - a.tv_sec) * 1e9 + (b.tv_nsec - a.tv_nsec)) / ITERATIONS;
+}
+
+int main(void)
+{
+    static const struct { const char *name; long period; } rates[] = {
+        { "0",      0     },
+        { "0.01 %", 10000 },
+        { "0.1 %",  1000  },
+        { "1 %",    100   },
+        { "10 %",   10    }
+    };
+    unsigned i;
+
+    printf("%-16s %22s %20s\n", "failure rate", "return codes ns/call", "exceptions ns/call");
+    for (i = 0; i < sizeof rates / sizeof rates[0]; i++)
+        printf("%-16s %22.2f %20.2f\n", rates[i].name,
+               run(rc_message, rates[i].period), run(exc_message, rates[i].period));
+    return 0;
+}
@@ -0,0 +1,113 @@
+/**
+ * =============================================================================
+ * bench/nonlocal.c
+ *
+ * Non-local fail-fast (ERRCHECK_ENABLE_NONLOCAL) versus per-frame
+ * propagation through a parser-like stack DEPTH frames deep. In the local
+ * variant every frame CHECKs its callee; in the non-local variant only the
+ * leaf checks and the top sets a landing pad.
+ *
+ *   gcc -O2 -std=gnu11 nonlocal.c -o nonlocal && ./nonlocal
+ *
+ * The success path trades DEPTH compare/branch pairs for one setjmp per
+ * message, so it wins once stacks are deep; failures cost the cleanup walk
+ * and a longjmp instead of DEPTH returns. Measured (gcc 12, x86-64, -O2,
+ * glibc, DEPTH=16; run-to-run spread about 10 %):
+ *
+ *     variant            success ns/msg   failure ns/msg
+ *     local                        55-60            56-64
+ *     nonlocal                     40-45            51-52
+ *
+ * setjmp saves the signal mask on some libcs; that cost dominates the
+ * non-local success path, so measure on your target before switching.
+ * =============================================================================
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <time.h>
+
+typedef enum {
+    ERR_NONE = 0,
+    ERR_FIELD,
+    ERR_MESSAGE
+} err_t;
+#define ERR_T
+
+#define ERR_FAILURE ((err_t)0xFF)
+
+#define ERRCHECK_ENABLE_NONLOCAL
+#include "../errcheck.h"
+
+err_t               g_last_error = ERR_NONE;
+errcheck_pad_t     *g_errcheck_pad;
+errcheck_cleanup_t *g_errcheck_cleanup;
+
+#define ITERATIONS 10000000L
+#define DEPTH      16
+
+/* Opaque leaf: validates one field (0 = bad) */
+__attribute__((noinline)) int field_ok(long v) { __asm__ volatile(""); return v >= 0; }
+
+/* ------------------------------------------------------------------------- */
+/* Local: every frame re-checks its callee                                   */
+/* ------------------------------------------------------------------------- */
+__attribute__((noinline)) err_t local_layer(long v, int depth)
+{
+    if (depth == 0) {
+        CHECK(field_ok(v), ERR_FIELD);
+        return ERR_NONE;
+    }
+    CHECK(local_layer(v, depth - 1) == ERR_NONE, ERR_FIELD);
+    return ERR_NONE;
+}
+
+__attribute__((noinline)) err_t local_message(long v)
+{
+    CHECK(local_layer(v, DEPTH - 1) == ERR_NONE, ERR_MESSAGE);
+    return ERR_NONE;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Non-local: void layers, one landing pad on top                            */
+/* ------------------------------------------------------------------------- */
+__attribute__((noinline)) void nonlocal_layer(long v, int depth)
+{
+    if (depth == 0) {
+        CHECK_VOID(field_ok(v), ERR_FIELD);
+        return;
+    }
+    nonlocal_layer(v, depth - 1);
+    __asm__ volatile("");                   /* keep the frame: no tail call */
+}
+
+__attribute__((noinline)) err_t nonlocal_message(long v)
+{
+    ERRCHECK_LANDING_PAD(pad) {
+        return ERR_FAILURE;
+    }
+    nonlocal_layer(v, DEPTH - 1);
+    return ERR_NONE;
+}
+
+/* ------------------------------------------------------------------------- */
+static double run(err_t (*fn)(long), long sign)
+{
+    struct timespec a, b;
+    long i, failed = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    for (i = 0; i < ITERATIONS; i++) failed += fn(sign * (i + 1)) != ERR_NONE;
+    clock_gettime(CLOCK_MONOTONIC, &b);
+
+    if (failed != (sign < 0 ? ITERATIONS : 0)) printf("unexpected result count %ld\n", failed);
+    return ((b.tv_sec - a.tv_sec) * 1e9 + (b.tv_nsec - a.tv_nsec)) / ITERATIONS;
+}
+
+int main(void)
+{
+    printf("%-16s %16s %16s\n", "variant", "success ns/msg", "failure ns/msg");
+    printf("%-16s %16.2f %16.2f\n", "local",    run(local_message, 1),    run(local_message, -1));
+    printf("%-16s %16.2f %16.2f\n", "nonlocal", run(nonlocal_message, 1), run(nonlocal_message, -1));
+    return 0;
+}
@@ -22,44 +22,1198 @@
     #define ERR_FAILURE ((err_t)0xFF)
 #endif
 
-extern err_t g_last_error;
+/* Storage class for per-thread state. Leave empty on bare metal; define as
+   _Thread_local (C11) or thread_local (C++) when CHECK runs on several threads,
+   and use it on your own definitions too:  ERRCHECK_TLS err_t g_last_error; */
+#ifndef ERRCHECK_TLS
+    #define ERRCHECK_TLS
+#endif
+
+extern ERRCHECK_TLS err_t g_last_error;
+
+/* ========================================================================= */
+/* Site Identifiers & Failure Hook                                           */
+/* ========================================================================= */
+
+/* Identifies the CHECK that failed in compact records. Receives the checked
+   call and the error code as written at the site, as string literals; the
+   default ignores both and uses the line number (override if needed). */
+#ifdef ERRCHECK_ENABLE_STABLE_SITE_IDS
+    /* __LINE__ moves whenever code above the site is edited, so ids in saved
+       plans and field traces go stale. Stable ids hash what identifies the
+       site instead: FNV-1a 32 over  function \x1F error \x1F call , with all
+       whitespace removed (0 is reserved for "any site" and maps to 1).
+       tools/site_ids.py computes the same ids from the sources, reports
+       collisions and prints the id → file:line map. */
+    #define ERRCHECK_FNV_PRIME_ 16777619u
+    #define ERRCHECK_FNV_BASIS_ 2166136261u
+    #define ERRCHECK_IS_SPACE_(c)                                          \
+        ((c) == ' ' || (c) == '\t' || (c) == '\n' || (c) == '\r' || (c) == '\v' || (c) == '\f')
+
+    #if defined(__cplusplus) && !defined(ERRCHECK_STABLE_SITE_IDS_RUNTIME)
+        #if __cplusplus >= 201402L
+            constexpr uint32_t errcheck_fnv_(const char *s, uint32_t h)
+            {
+                for (; *s; s++)
+                    if (!ERRCHECK_IS_SPACE_(*s)) h = (h ^ (uint8_t)*s) * ERRCHECK_FNV_PRIME_;
+                return h;
+            }
+        #else
+            constexpr uint32_t errcheck_fnv_(const char *s, uint32_t h)
+            {
+                return *s == 0 ? h : errcheck_fnv_(s + 1, ERRCHECK_IS_SPACE_(*s) ? h
+                                                   : (h ^ (uint8_t)*s) * ERRCHECK_FNV_PRIME_);
+            }
+        #endif
+        constexpr uint32_t errcheck_fnv_field_(const char *s, uint32_t h)
+        {
+            return errcheck_fnv_(s, (h ^ 0x1Fu) * ERRCHECK_FNV_PRIME_);
+        }
+        constexpr uint32_t errcheck_site_nonzero_(uint32_t h) { return h ? h : 1u; }
+        constexpr uint32_t errcheck_site_hash_(const char *func, const char *err, const char *call)
+        {
+            return errcheck_site_nonzero_(errcheck_fnv_field_(call,
+                       errcheck_fnv_field_(err, errcheck_fnv_(func, ERRCHECK_FNV_BASIS_))));
+        }
+
+        /* Forces evaluation at compile time: the id is an immediate operand */
+        template <uint32_t V> struct errcheck_site_const_ { static const uint32_t value = V; };
+        #define ERRCHECK_SITE_ID(call_s, err_s)                            \
+            (errcheck_site_const_<errcheck_site_hash_(__func__, err_s, call_s)>::value)
+    #else
+        static inline uint32_t errcheck_fnv_(const char *s, uint32_t h)
+        {
+            for (; *s; s++)
+                if (!ERRCHECK_IS_SPACE_(*s)) h = (h ^ (uint8_t)*s) * ERRCHECK_FNV_PRIME_;
+            return h;
+        }
+        static inline uint32_t errcheck_site_hash_(const char *func, const char *err, const char *call)
+        {
+            uint32_t h = errcheck_fnv_(func, ERRCHECK_FNV_BASIS_);
+            h = errcheck_fnv_(err, (h ^ 0x1Fu) * ERRCHECK_FNV_PRIME_);
+            h = errcheck_fnv_(call, (h ^ 0x1Fu) * ERRCHECK_FNV_PRIME_);
+            return h ? h : 1u;
+        }
+
+        /* C has no constexpr: hashed once per site, on first use, then cached */
+        #define ERRCHECK_SITE_ID(call_s, err_s) __extension__ ({               \
+            static uint32_t errcheck_site_;                                    \
+            uint32_t errcheck_id_ = __atomic_load_n(&errcheck_site_, __ATOMIC_RELAXED); \
+            if (__builtin_expect(errcheck_id_ == 0, 0)) {                      \
+                errcheck_id_ = errcheck_site_hash_(__func__, err_s, call_s);   \
+                __atomic_store_n(&errcheck_site_, errcheck_id_, __ATOMIC_RELAXED); \
+            }                                                                  \
+            errcheck_id_;                                                      \
+        })
+    #endif
+#endif
+
+#ifndef ERRCHECK_SITE_ID
+    #define ERRCHECK_SITE_ID(call_s, err_s) ((uint32_t)__LINE__)
+#endif
+
+/* Failure tail of every check form. ERRCHECK_SITE_ID is evaluated once into
+   a local: in C with stable ids each expansion of it is a separate cached
+   statement expression, and ON_FAILURE_ pastes 'site' into every part. */
+#define ERRCHECK_FAILURE_SITE_(site, err_flag) do {                        \
+    const uint32_t errcheck_site_ = (site);                                \
+    (void)errcheck_site_;                                                  \
+    ERRCHECK_ON_FAILURE_(errcheck_site_, err_flag);                        \
+    ERRCHECK_UNWIND_(errcheck_site_, err_flag);                            \
+} while (0)
+
+/* Runs on every failure after g_last_error is set; each part is empty unless
+   the matching optional feature below is enabled */
+#define ERRCHECK_ON_FAILURE_(site, err_flag) do {                          \
+    ERRCHECK_PENDING_(site);                                               \
+    ERRCHECK_ORIGIN_(site);                                                \
+    ERRCHECK_CHAIN_((site), (err_flag));                                   \
+    ERRCHECK_ROLLUP_(err_flag);                                            \
+    ERRCHECK_REPORT_((site), (err_flag));                                  \
+    ERRCHECK_HOOKS_((site), (err_flag));                                   \
+} while (0)
+
+/* ========================================================================= */
+/* Optional: Time Source                                                     */
+/* ========================================================================= */
+/* Windowed features read a millisecond clock and CHECK_RETRY sleeps between
+   attempts. Provide errcheck_time_ms() / errcheck_sleep_ms() (e.g. HAL_GetTick,
+   HAL_Delay) or define ERRCHECK_NOW_MS() / ERRCHECK_SLEEP_MS(ms) yourself.
+
+   ERRCHECK_ENABLE_VIRTUAL_TIME replaces both with a virtual clock for tests:
+   time only moves when the test (or a sleep) advances it, so a 30-minute
+   backoff runs in microseconds and every run sees the same timeline.
+
+       uint32_t g_errcheck_vclock_ms;
+       errcheck_vclock_advance(60000);     // one minute later, instantly
+
+   Dedup windows, injection-plan windows and CHECK_RETRY all follow it. The
+   profiler keeps its own ERRCHECK_TICKS(): it measures real CPU cost. */
+#ifdef ERRCHECK_ENABLE_VIRTUAL_TIME
+    extern uint32_t g_errcheck_vclock_ms;
+
+    #define ERRCHECK_NOW_MS()     __atomic_load_n(&g_errcheck_vclock_ms, __ATOMIC_RELAXED)
+    #define ERRCHECK_SLEEP_MS(ms) errcheck_vclock_advance(ms)
+
+    static inline void errcheck_vclock_set(uint32_t ms)
+    {
+        __atomic_store_n(&g_errcheck_vclock_ms, ms, __ATOMIC_RELAXED);
+    }
+
+    static inline void errcheck_vclock_advance(uint32_t ms)
+    {
+        __atomic_fetch_add(&g_errcheck_vclock_ms, ms, __ATOMIC_RELAXED);
+    }
+#endif
+
+#ifndef ERRCHECK_NOW_MS
+    extern uint32_t errcheck_time_ms(void);
+    #define ERRCHECK_NOW_MS() errcheck_time_ms()
+#endif
+
+#ifndef ERRCHECK_SLEEP_MS
+    extern void errcheck_sleep_ms(uint32_t ms);
+    #define ERRCHECK_SLEEP_MS(ms) errcheck_sleep_ms(ms)
+#endif
+
+/* Wrap-safe: nonzero once the clock has reached 'deadline' (within 2^31 ms) */
+#define ERRCHECK_DEADLINE_PASSED(deadline)                                 \
+    ((int32_t)(uint32_t)(ERRCHECK_NOW_MS() - (uint32_t)(deadline)) >= 0)
 
 /* ========================================================================= */
 /* Core Macros                                                               */
 /* ========================================================================= */
 
-/* Standard check with specific error code */
-#define CHECK(call, err_flag) do {                     \
-    if ((call) == 0) {                                 \
-        g_last_error = (err_flag);                     \
-        return ERR_FAILURE;                            \
-    }                                                  \
+/* Every public form stringizes its own arguments, so ERRCHECK_SITE_ID sees
+   the site's text as written rather than a macro-expanded rewrite of it.
+   The site text is every argument except the error code and the control
+   arguments (retval, retry limits). */
+#define ERRCHECK_CHECK_(cond, err_flag, retval, call_s, err_s) do {       \
+    ERRCHECK_PROFILE_BEGIN_()                                              \
+    if (ERRCHECK_FAILED_OR_INJECTED_(                                      \
+            ERRCHECK_EVAL_(cond, ERRCHECK_SITE_ID(call_s, err_s)) == 0,    \
+            ERRCHECK_SITE_ID(call_s, err_s), err_flag)) {                  \
+        g_last_error = (err_flag);                                         \
+        ERRCHECK_INJECT_CLEAR_();                                          \
+        ERRCHECK_FAILURE_SITE_(ERRCHECK_SITE_ID(call_s, err_s), err_flag); \
+        return retval;                                                     \
+    }                                                                      \
+    ERRCHECK_ON_SUCCESS_(ERRCHECK_SITE_ID(call_s, err_s));                 \
 } while (0)
 
+/* Standard check with specific error code */
+#define CHECK(call, err_flag)                                              \
+    ERRCHECK_CHECK_((call), (err_flag), ERR_FAILURE, #call, #err_flag)
+
+/* Same check for functions that do not return err_t:
+     CHECK_RET(call, err, NULL) in pointer functions, CHECK_RET(call, err, false)
+     in bool functions, CHECK_VOID(call, err) in void functions.
+   Injection and every failure hook behave exactly as in CHECK. */
+#define CHECK_RET(call, err_flag, retval)                                  \
+    ERRCHECK_CHECK_((call), (err_flag), retval, #call, #err_flag)
+
+#define CHECK_VOID(call, err_flag)                                         \
+    ERRCHECK_CHECK_((call), (err_flag), , #call, #err_flag)
+
 /* When many calls share the same error code */
-#define CHECK_SAME(call) CHECK((call), g_current_error_group)
+#define CHECK_SAME(call)                                                   \
+    ERRCHECK_CHECK_((call), g_current_error_group, ERR_FAILURE, #call, "g_current_error_group")
 
 /* Manual return with error */
-#define RETURN_ERR(err_flag) do {                      \
-    g_last_error = (err_flag);                         \
-    return ERR_FAILURE;                                \
+#define RETURN_ERR(err_flag) ERRCHECK_RETURN_ERR_((err_flag), ERR_FAILURE, #err_flag)
+
+#define RETURN_ERR_RET(err_flag, retval) ERRCHECK_RETURN_ERR_((err_flag), retval, #err_flag)
+
+#define ERRCHECK_RETURN_ERR_(err_flag, retval, err_s) do {                 \
+    g_last_error = (err_flag);                                             \
+    {                                                                      \
+        const uint32_t errcheck_site_ = ERRCHECK_SITE_ID("", err_s);       \
+        ERRCHECK_PLAN_FAILED_(errcheck_site_, err_flag);                   \
+        ERRCHECK_ON_FAILURE_(errcheck_site_, err_flag);                    \
+        ERRCHECK_UNWIND_(errcheck_site_, err_flag);                        \
+    }                                                                      \
+    return retval;                                                         \
 } while (0)
 
+#define RETURN_ERR_VOID(err_flag) ERRCHECK_RETURN_ERR_((err_flag), , #err_flag)
+
+/* ========================================================================= */
+/* Type-Generic Checks                                                       */
+/* ========================================================================= */
+/* CHECK treats == 0 as failure. These forms pick the failure test from the
+ * call's return type instead. Every form evaluates 'call' exactly once.
+ *
+ *   CHECK_PTR(call, err)          fails on NULL
+ *   CHECK_ERRNO(call, err)        fails on < 0          (POSIX / negative errno)
+ *   CHECK_BOOL(call, err)         fails on false
+ *   CHECK_STATUS(call, ok, err)   fails on != ok        (HAL status enums)
+ *   CHECK_T(call, err)            dispatches on the type at compile time:
+ *                                   bool → false, pointer → NULL,
+ *                                   signed integer → < 0, unsigned → == 0
+ *
+ * CHECK_T needs C11 _Generic or C++. In C an enum takes the rule of its
+ * underlying integer type, so use CHECK_STATUS for status enums. In C++
+ * specialise errcheck_fail_traits<YourStatus> instead.
+ */
+#define CHECK_PTR(call, err_flag)                                          \
+    ERRCHECK_CHECK_((call) != 0, (err_flag), ERR_FAILURE, #call, #err_flag)
+#define CHECK_ERRNO(call, err_flag)                                        \
+    ERRCHECK_CHECK_((call) >= 0, (err_flag), ERR_FAILURE, #call, #err_flag)
+#define CHECK_BOOL(call, err_flag)                                         \
+    ERRCHECK_CHECK_(!!(call), (err_flag), ERR_FAILURE, #call, #err_flag)
+#define CHECK_STATUS(call, ok, err_flag)                                   \
+    ERRCHECK_CHECK_((call) == (ok), (err_flag), ERR_FAILURE, #call "," #ok, #err_flag)
+
+#if defined(__cplusplus)
+    template <typename T> struct errcheck_fail_traits;   /* undefined: no rule for T */
+
+    template <> struct errcheck_fail_traits<bool> {
+        static inline bool failed(bool v) { return !v; }
+    };
+    template <typename T> struct errcheck_fail_traits<T *> {
+        static inline bool failed(T *v) { return v == 0; }
+    };
+    #define ERRCHECK_FAIL_RULE_(type, test)                                \
+        template <> struct errcheck_fail_traits<type> {                    \
+            static inline bool failed(type v) { return test; }             \
+        };
+    ERRCHECK_FAIL_RULE_(signed char,        v < 0)
+    ERRCHECK_FAIL_RULE_(short,              v < 0)
+    ERRCHECK_FAIL_RULE_(int,                v < 0)
+    ERRCHECK_FAIL_RULE_(long,               v < 0)
+    ERRCHECK_FAIL_RULE_(long long,          v < 0)
+    ERRCHECK_FAIL_RULE_(char,               v == 0)
+    ERRCHECK_FAIL_RULE_(unsigned char,      v == 0)
+    ERRCHECK_FAIL_RULE_(unsigned short,     v == 0)
+    ERRCHECK_FAIL_RULE_(unsigned int,       v == 0)
+    ERRCHECK_FAIL_RULE_(unsigned long,      v == 0)
+    ERRCHECK_FAIL_RULE_(unsigned long long, v == 0)
+    #undef ERRCHECK_FAIL_RULE_
+
+    template <typename T> static inline bool errcheck_failed_t_(T v)
+    {
+        return errcheck_fail_traits<T>::failed(v);
+    }
+    #define ERRCHECK_FAILED_T(v) errcheck_failed_t_(v)
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+    static inline int errcheck_failed_bool_(_Bool v)               { return !v; }
+    static inline int errcheck_failed_neg_(long long v)            { return v < 0; }
+    static inline int errcheck_failed_zero_(unsigned long long v)  { return v == 0; }
+    static inline int errcheck_failed_ptr_(const volatile void *v) { return v == 0; }
+
+    /* The controlling expression is not evaluated; only the argument is */
+    #define ERRCHECK_FAILED_T(v) _Generic((v),                             \
+        _Bool:              errcheck_failed_bool_,                         \
+        signed char:        errcheck_failed_neg_,                          \
+        short:              errcheck_failed_neg_,                          \
+        int:                errcheck_failed_neg_,                          \
+        long:               errcheck_failed_neg_,                          \
+        long long:          errcheck_failed_neg_,                          \
+        char:               errcheck_failed_zero_,                         \
+        unsigned char:      errcheck_failed_zero_,                         \
+        unsigned short:     errcheck_failed_zero_,                         \
+        unsigned int:       errcheck_failed_zero_,                         \
+        unsigned long:      errcheck_failed_zero_,                         \
+        unsigned long long: errcheck_failed_zero_,                         \
+        default:            errcheck_failed_ptr_)(v)
+#endif
+
+#ifdef ERRCHECK_FAILED_T
+    #define CHECK_T(call, err_flag)                                        \
+        ERRCHECK_CHECK_(!ERRCHECK_FAILED_T(call), (err_flag), ERR_FAILURE, #call, #err_flag)
+#endif
+
+/* ========================================================================= */
+/* Check-and-Bind                                                            */
+/* ========================================================================= */
+/* Evaluate a value-returning call once, store the result in 'var' and fail
+ * fast on its sentinel. 'var' is an ordinary local, so it stays in a
+ * register; the code is the same as the hand-written assign-then-test.
+ *
+ *   int   fd;
+ *   CHECK_ASSIGN(fd, open(path, O_RDONLY), ERR_OPEN);       // CHECK_T rule: < 0
+ *   CHECK_ASSIGN_NOT(len, uart_read(buf), 0u, ERR_UART);    // explicit sentinel
+ *
+ * Without C11/C++ CHECK_ASSIGN falls back to the CHECK rule (== 0 fails).
+ */
+#ifdef ERRCHECK_FAILED_T
+    #define CHECK_ASSIGN(var, call, err_flag)                              \
+        ERRCHECK_CHECK_(!ERRCHECK_FAILED_T((var) = (call)), (err_flag),    \
+                        ERR_FAILURE, #var "," #call, #err_flag)
+#else
+    #define CHECK_ASSIGN(var, call, err_flag)                              \
+        ERRCHECK_CHECK_(((var) = (call)) != 0, (err_flag),                 \
+                        ERR_FAILURE, #var "," #call, #err_flag)
+#endif
+
+#define CHECK_ASSIGN_NOT(var, call, sentinel, err_flag)                    \
+    ERRCHECK_CHECK_(((var) = (call)) != (sentinel), (err_flag),            \
+                    ERR_FAILURE, #var "," #call "," #sentinel, #err_flag)
+
+/* ========================================================================= */
+/* Retry with Backoff                                                        */
+/* ========================================================================= */
+/* Re-evaluates 'call' up to 'tries' times, sleeping ERRCHECK_SLEEP_MS between
+ * attempts with the delay doubling from 'base_ms' (capped at
+ * ERRCHECK_RETRY_MAX_MS). Only the last failure takes the CHECK failure path.
+ *
+ *   CHECK_RETRY(modem_attach(), ERR_MODEM, 6, 500);   // 500, 1000, ... 8000 ms
+ *
+ * Injection works as for CHECK, on the attempt it fires on; every remaining
+ * attempt then fails as well (without calling 'call' again), so an injected
+ * outage outlasts the backoff and a seq rule replays a recorded CHECK_RETRY
+ * failure. A natural last failure consumes its seq step like a CHECK. With
+ * ERRCHECK_ENABLE_VIRTUAL_TIME the sleeps advance the virtual clock instead
+ * of blocking.
+ */
+#ifndef ERRCHECK_RETRY_MAX_MS
+    #define ERRCHECK_RETRY_MAX_MS 60000u
+#endif
+
+#define CHECK_RETRY(call, err_flag, tries, base_ms)                        \
+    ERRCHECK_CHECK_RETRY_((call), (err_flag), (tries), (base_ms), #call, #err_flag)
+
+#define ERRCHECK_CHECK_RETRY_(call, err_flag, tries, base_ms, call_s, err_s) do { \
+    uint32_t errcheck_try_ = 1, errcheck_delay_ = (uint32_t)(base_ms);     \
+    int errcheck_injected_ = 0;                                            \
+    while (errcheck_injected_ || (call) == 0 ||                            \
+           (errcheck_injected_ =                                           \
+                ERRCHECK_INJECTED_(ERRCHECK_SITE_ID(call_s, err_s), err_flag)) != 0) { \
+        ERRCHECK_INJECT_CLEAR_();                                          \
+        if (errcheck_try_++ >= (uint32_t)(tries)) {                        \
+            const uint32_t errcheck_site_ = ERRCHECK_SITE_ID(call_s, err_s); \
+            g_last_error = (err_flag);                                     \
+            if (!errcheck_injected_) ERRCHECK_PLAN_FAILED_(errcheck_site_, err_flag); \
+            ERRCHECK_ON_FAILURE_(errcheck_site_, err_flag);                \
+            ERRCHECK_UNWIND_(errcheck_site_, err_flag);                    \
+            return ERR_FAILURE;                                            \
+        }                                                                  \
+        ERRCHECK_SLEEP_MS(errcheck_delay_);                                \
+        errcheck_delay_ = errcheck_delay_ >= ERRCHECK_RETRY_MAX_MS / 2     \
+                        ? ERRCHECK_RETRY_MAX_MS : errcheck_delay_ * 2;     \
+    }                                                                      \
+    ERRCHECK_ON_SUCCESS_(ERRCHECK_SITE_ID(call_s, err_s));                 \
+} while (0)
+
+/* ========================================================================= */
+/* Reader Tracking (shared by injection plans and check levels)              */
+/* ========================================================================= */
+/* Readers of a published table enter under the current epoch and count
+   themselves in that epoch's parity. A table replaced during epoch e can be
+   freed once the epoch has moved past e and no reader of e is left; the
+   reload watcher polls for this and never blocks on a slow reader. */
+#if defined(ERRCHECK_ENABLE_INJECTION_PLAN) || defined(ERRCHECK_ENABLE_CHECK_LEVELS)
+    typedef struct {
+        uint32_t epoch;
+        uint32_t active[2];   /* readers inside, by epoch parity */
+    } errcheck_readers_t;
+
+    /* seq_cst: the count must be visible before the table pointer is read */
+    static inline uint32_t errcheck_read_begin_(errcheck_readers_t *r)
+    {
+        for (;;) {
+            uint32_t e = __atomic_load_n(&r->epoch, __ATOMIC_SEQ_CST);
+            __atomic_fetch_add(&r->active[e & 1u], 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&r->epoch, __ATOMIC_SEQ_CST) == e) return e;
+            __atomic_fetch_sub(&r->active[e & 1u], 1, __ATOMIC_RELEASE);
+        }
+    }
+
+    static inline void errcheck_read_end_(errcheck_readers_t *r, uint32_t e)
+    {
+        __atomic_fetch_sub(&r->active[e & 1u], 1, __ATOMIC_RELEASE);
+    }
+#endif
+
+/* ========================================================================= */
+/* Optional: Tiered Check Levels                                             */
+/* ========================================================================= */
+/* Expensive validations (a config CRC, a sensor cross-check) get a level and
+ * run only where that level is enabled, e.g. on canary hosts:
+ *
+ *     CHECK_LEVEL(LEVEL_PARANOID, config_crc_ok(cfg), ERR_CONFIG);
+ *
+ * A disabled CHECK_LEVEL skips the call entirely. Levels are 1..32, one bit
+ * each in the published configuration's mask; per-site overrides (by site
+ * id, as in injection plans) take precedence over the mask:
+ *
+ *     errcheck_levels_t *g_errcheck_levels;       // NULL = every level off
+ *     uint32_t           g_errcheck_level_gen;
+ *     errcheck_readers_t g_errcheck_level_readers;
+ *
+ *     static errcheck_level_override_t quiet[] = { { 0x5D1C0A7Eu, 0 } };
+ *     static errcheck_levels_t canary = { ERRCHECK_LEVEL_BIT(LEVEL_PARANOID), 1, quiet };
+ *     errcheck_levels_publish(&canary);
+ *
+ * Each site caches its decision together with the generation it was made
+ * in, so an enabled or disabled site costs two loads and a compare; only
+ * its first pass, and the first after each publish, looks at the
+ * configuration (a statically initialised one applies from the start). The
+ * hot-reload watcher accepts level lines in the same file as injection rules.
+ *
+ * Without ERRCHECK_ENABLE_CHECK_LEVELS every CHECK_LEVEL is a plain CHECK.
+ */
+#ifdef ERRCHECK_ENABLE_CHECK_LEVELS
+    typedef struct {
+        uint32_t site;
+        uint32_t on;         /* 0 = skip this site, else run it */
+    } errcheck_level_override_t;
+
+    typedef struct {
+        uint32_t                   mask;   /* ERRCHECK_LEVEL_BIT(level) = enabled */
+        uint32_t                   n;
+        errcheck_level_override_t *site;
+    } errcheck_levels_t;
+
+    extern errcheck_levels_t *g_errcheck_levels;
+    extern uint32_t           g_errcheck_level_gen;
+    extern errcheck_readers_t g_errcheck_level_readers;
+
+    #define ERRCHECK_LEVEL_BIT(level) (1u << ((uint32_t)(level) - 1u))
+
+    /* Publishes 'lv' (NULL turns every level off); returns the one it replaced.
+       As with plans, free a replaced configuration only once no CHECK_LEVEL
+       can still be resolving against it (g_errcheck_level_readers). */
+    static inline errcheck_levels_t *errcheck_levels_publish(errcheck_levels_t *lv)
+    {
+        errcheck_levels_t *old = __atomic_exchange_n(&g_errcheck_levels, lv, __ATOMIC_SEQ_CST);
+        __atomic_fetch_add(&g_errcheck_level_gen, 1, __ATOMIC_RELEASE);
+        return old;
+    }
+
+    /* Never 0 (bit 30 is always set), so the zeroed cache of a site that was
+       never resolved cannot pass for a decision made before the first publish */
+    static inline uint32_t errcheck_level_gen_(void)
+    {
+        return (__atomic_load_n(&g_errcheck_level_gen, __ATOMIC_ACQUIRE) & 0x3FFFFFFFu) | 0x40000000u;
+    }
+
+    /* Slow path: decides a site against the current configuration and caches
+       (generation << 1 | on). A publish racing with this only costs another
+       resolve, because the cached generation is the one read first. */
+    __attribute__((noinline, cold, unused))
+    static uint32_t errcheck_level_resolve_(uint32_t *cache, uint32_t level, uint32_t site)
+    {
+        uint32_t gen = errcheck_level_gen_(), on = 0, i;
+        uint32_t epoch = errcheck_read_begin_(&g_errcheck_level_readers);
+        const errcheck_levels_t *lv = __atomic_load_n(&g_errcheck_levels, __ATOMIC_SEQ_CST);
+
+        if (lv) {
+            on = level >= 1u && level <= 32u && (lv->mask & ERRCHECK_LEVEL_BIT(level)) != 0;
+            for (i = 0; i < lv->n; i++) {
+                if (lv->site[i].site == site) { on = lv->site[i].on != 0; break; }
+            }
+        }
+        errcheck_read_end_(&g_errcheck_level_readers, epoch);
+        __atomic_store_n(cache, gen << 1 | on, __ATOMIC_RELAXED);
+        return gen << 1 | on;
+    }
+
+    #define ERRCHECK_CHECK_LEVEL_(level, cond, err_flag, retval, call_s, err_s) do { \
+        static uint32_t errcheck_level_cache_;                             \
+        uint32_t errcheck_level_ = __atomic_load_n(&errcheck_level_cache_, __ATOMIC_RELAXED); \
+        if ((errcheck_level_ >> 1) != errcheck_level_gen_())               \
+            errcheck_level_ = errcheck_level_resolve_(&errcheck_level_cache_, \
+                                  (uint32_t)(level), ERRCHECK_SITE_ID(call_s, err_s)); \
+        if (errcheck_level_ & 1u)                                          \
+            ERRCHECK_CHECK_(cond, err_flag, retval, call_s, err_s);        \
+    } while (0)
+#else
+    #define ERRCHECK_CHECK_LEVEL_(level, cond, err_flag, retval, call_s, err_s) \
+        ERRCHECK_CHECK_(cond, err_flag, retval, call_s, err_s)
+#endif
+
+#define CHECK_LEVEL(level, call, err_flag)                                 \
+    ERRCHECK_CHECK_LEVEL_((level), (call), (err_flag), ERR_FAILURE, #call, #err_flag)
+
+#define CHECK_LEVEL_RET(level, call, err_flag, retval)                     \
+    ERRCHECK_CHECK_LEVEL_((level), (call), (err_flag), retval, #call, #err_flag)
+
+#define CHECK_LEVEL_VOID(level, call, err_flag)                            \
+    ERRCHECK_CHECK_LEVEL_((level), (call), (err_flag), , #call, #err_flag)
+
 /* ========================================================================= */
 /* Optional: Runtime Fault Injection (Debug builds only)                     */
 /* ========================================================================= */
 #ifdef ERRCHECK_ENABLE_RUNTIME_INJECTION
     extern volatile uint8_t g_inject_error_flag;
-    #undef CHECK
-    #define CHECK(call, err_flag) do {                 \
-        if ((call) == 0 || g_inject_error_flag == (err_flag)) { \
-            g_last_error = (err_flag);                 \
-            g_inject_error_flag = 0;                   \
-            return ERR_FAILURE;                        \
-        }                                              \
-    } while (0)
+    #define ERRCHECK_INJECT_FLAG_(err_flag) (g_inject_error_flag == (err_flag))
+    #define ERRCHECK_INJECT_CLEAR_()        (g_inject_error_flag = 0)
+#else
+    #define ERRCHECK_INJECT_FLAG_(err_flag) 0
+    #define ERRCHECK_INJECT_CLEAR_()        ((void)0)
 #endif
 
+/* ========================================================================= */
+/* Optional: Runtime Injection Plans                                         */
+/* ========================================================================= */
+/* A plan is an immutable list of rules, published through one atomic
+ * pointer. CHECK readers load the pointer once: NULL (disarmed) costs that
+ * single load; a published plan is never modified, so a reader can never
+ * see it half-updated. Only the per-rule hit counters change.
+ *
+ *     errcheck_inject_plan_t *g_errcheck_inject_plan;      // NULL = disarmed
+ *     errcheck_readers_t      g_errcheck_plan_readers;
+ *
+ *     static errcheck_inject_rule_t rules[] = {
+ *         { ERR_RADIO, 0, 3, 2 },      // every ERR_RADIO site: pass 3, fail 2
+ *     };
+ *     static errcheck_inject_plan_t plan = { 1, rules };
+ *     errcheck_inject_publish(&plan);
+ *
+ * A replaced plan may still be read by a CHECK in flight; free it only once
+ * g_errcheck_plan_readers shows no reader left (the reload watcher does this
+ * for you). A plan with a 'seen' callback reports every check evaluated while
+ * it is armed; the callback runs inside the read.
+ *
+ * Rules can be narrowed to one thread and/or to calls made beneath a scope:
+ *
+ *     ERRCHECK_TLS uint32_t g_errcheck_thread_tag;    // 0 = untagged
+ *     ERRCHECK_TLS uint32_t g_errcheck_scope_mask;    // active scopes
+ *
+ *     void *telemetry_main(void *arg) { errcheck_set_thread_tag(THREAD_TELEMETRY); ... }
+ *
+ *     err_t upload_logs(void)
+ *     {
+ *         ERRCHECK_SCOPE(SCOPE_UPLOAD);       // active until this function returns
+ *         CHECK(radio_send(buf), ERR_RADIO);  // also covers everything called from here
+ *     }
+ *
+ *     { ERR_RADIO, 0, 0, 0, 0, THREAD_TELEMETRY, SCOPE_UPLOAD }
+ *
+ * Scope tags are 1..32 (one bit each; other values are ignored);
+ * ERRCHECK_SCOPE restores the previous set on every return path, including
+ * a failing CHECK.
+ *
+ * Rules can also be limited in time, to reproduce burst outages:
+ *   start/end     active only while start <= now < end; start 0 = from
+ *                 boot, end 0 = open-ended (wrap-safe, spans < 2^31 ms)
+ *   period/duty   active during the first 'duty' ms of every 'period' ms
+ * 'now' is a cached coarse clock, so a windowed rule costs one extra load:
+ *
+ *     uint32_t g_errcheck_coarse_ms;
+ *     void SysTick_Handler(void) { errcheck_coarse_tick(); }   // or a timer thread
+ */
+#ifdef ERRCHECK_ENABLE_INJECTION_PLAN
+    typedef struct {
+        uint32_t err;        /* code to inject */
+        uint32_t site;       /* 0 = every site checking 'err' */
+        uint32_t after;      /* let this many matching checks pass first */
+        uint32_t count;      /* then fail this many; 0 = keep failing */
+        uint32_t hits;       /* matching checks seen (atomic) */
+        uint32_t thread;     /* only this thread tag; 0 = any thread */
+        uint32_t scope;      /* only beneath this scope tag (1..32); 0 = anywhere */
+        uint32_t start;      /* coarse ms; active from here (0 = from boot) ... */
+        uint32_t end;        /* ... until here (0 = open-ended) */
+        uint32_t period;     /* duty cycle: fail 'duty' ms of every 'period' ms */
+        uint32_t duty;       /*             0 = no duty cycle */
+        uint32_t seq;        /* replay order (1, 2, ...): fires once, after seq-1; 0 = unordered */
+    } errcheck_inject_rule_t;
+
+    typedef struct {
+        uint32_t                n;
+        errcheck_inject_rule_t *rule;
+        uint32_t                cursor;   /* last 'seq' that fired (atomic) */
+        void                  (*seen)(uint32_t site, uint32_t err);  /* observer; NULL = none */
+    } errcheck_inject_plan_t;
+
+    extern errcheck_inject_plan_t *g_errcheck_inject_plan;
+    extern errcheck_readers_t      g_errcheck_plan_readers;
+    extern ERRCHECK_TLS uint32_t   g_errcheck_thread_tag;
+    extern ERRCHECK_TLS uint32_t   g_errcheck_scope_mask;
+
+    extern uint32_t                g_errcheck_coarse_ms;
+
+    static inline void errcheck_set_thread_tag(uint32_t tag) { g_errcheck_thread_tag = tag; }
+
+    /* Refreshes the cached clock used by windowed rules */
+    static inline void errcheck_coarse_tick(void)
+    {
+        __atomic_store_n(&g_errcheck_coarse_ms, ERRCHECK_NOW_MS(), __ATOMIC_RELAXED);
+    }
+
+    /* A virtual clock is already a single load: windows read it directly */
+    #ifdef ERRCHECK_ENABLE_VIRTUAL_TIME
+        #define ERRCHECK_COARSE_MS_() ERRCHECK_NOW_MS()
+    #else
+        #define ERRCHECK_COARSE_MS_() __atomic_load_n(&g_errcheck_coarse_ms, __ATOMIC_RELAXED)
+    #endif
+
+    static inline int errcheck_rule_in_window_(const errcheck_inject_rule_t *r)
+    {
+        uint32_t now = ERRCHECK_COARSE_MS_();
+        if (r->start != 0 && (int32_t)(now - r->start) < 0) return 0;
+        if (r->end != 0 && (int32_t)(now - r->end) >= 0) return 0;
+        if (r->period != 0 && (now % r->period) >= r->duty) return 0;
+        return 1;
+    }
+
+    /* Tags outside 1..32 enter no scope (and never shift out of range) */
+    static inline uint32_t errcheck_scope_enter_(uint32_t tag)
+    {
+        uint32_t saved = g_errcheck_scope_mask;
+        if (tag - 1u < 32u) g_errcheck_scope_mask = saved | (1u << (tag - 1u));
+        return saved;
+    }
+
+    static inline void errcheck_scope_leave_(uint32_t *saved) { g_errcheck_scope_mask = *saved; }
+
+    /* Each use names its own local, so several scopes can share a block */
+    #define ERRCHECK_SCOPE(tag)                                            \
+        ERRCHECK_SCOPE_AS_(ERRCHECK_SCOPE_NAME_(__COUNTER__), tag)
+    #define ERRCHECK_SCOPE_NAME_(n)  ERRCHECK_SCOPE_NAME2_(n)
+    #define ERRCHECK_SCOPE_NAME2_(n) errcheck_scope_saved_##n##_
+    #define ERRCHECK_SCOPE_AS_(name, tag)                                  \
+        uint32_t name __attribute__((cleanup(errcheck_scope_leave_))) =    \
+            errcheck_scope_enter_((uint32_t)(tag))
+
+    /* Publishes 'plan' (NULL disarms); returns the plan it replaced */
+    static inline errcheck_inject_plan_t *errcheck_inject_publish(errcheck_inject_plan_t *plan)
+    {
+        return __atomic_exchange_n(&g_errcheck_inject_plan, plan, __ATOMIC_SEQ_CST);
+    }
+
+    static inline int errcheck_plan_hit_(errcheck_inject_plan_t *p, uint32_t site, uint32_t err)
+    {
+        uint32_t i, n;
+        if (p->seen) p->seen(site, err);
+        for (i = 0; i < p->n; i++) {
+            errcheck_inject_rule_t *r = &p->rule[i];
+            if (r->err != err || (r->site != 0 && r->site != site)) continue;
+            if (r->thread != 0 && r->thread != g_errcheck_thread_tag) continue;
+            if (r->scope != 0 && !(g_errcheck_scope_mask & (1u << (r->scope - 1u)))) continue;
+            if ((r->start | r->end | r->period) != 0 && !errcheck_rule_in_window_(r)) continue;
+            if (r->seq != 0) {
+                /* replayed sequence: only the next step may fire, exactly once */
+                uint32_t prev = r->seq - 1u;
+                if (__atomic_compare_exchange_n(&p->cursor, &prev, r->seq, 0,
+                                                __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) return 1;
+                continue;
+            }
+            n = __atomic_fetch_add(&r->hits, 1, __ATOMIC_RELAXED);
+            if (n >= r->after && (r->count == 0 || n - r->after < r->count)) return 1;
+        }
+        return 0;
+    }
+
+    static inline int errcheck_plan_armed_(void)
+    {
+        return __builtin_expect(__atomic_load_n(&g_errcheck_inject_plan, __ATOMIC_RELAXED) != 0, 0);
+    }
+
+    static inline int errcheck_plan_injected_(uint32_t site, uint32_t err)
+    {
+        uint32_t epoch = errcheck_read_begin_(&g_errcheck_plan_readers);
+        errcheck_inject_plan_t *p = __atomic_load_n(&g_errcheck_inject_plan, __ATOMIC_SEQ_CST);
+        int hit = p != 0 && errcheck_plan_hit_(p, site, err);
+        errcheck_read_end_(&g_errcheck_plan_readers, epoch);
+        return hit;
+    }
+
+    /* A check that fails by itself still consumes the seq step recorded for
+       it. In the field every frame a failure propagates through logs its own
+       record; on replay those frames fail naturally, and without this the
+       cursor would stop at the first of them. */
+    static inline void errcheck_plan_failed_(uint32_t site, uint32_t err)
+    {
+        uint32_t epoch = errcheck_read_begin_(&g_errcheck_plan_readers);
+        errcheck_inject_plan_t *p = __atomic_load_n(&g_errcheck_inject_plan, __ATOMIC_SEQ_CST);
+        uint32_t i, prev;
+
+        for (i = 0; p && i < p->n; i++) {
+            const errcheck_inject_rule_t *r = &p->rule[i];
+            if (r->seq == 0 || r->err != err || (r->site != 0 && r->site != site)) continue;
+            prev = r->seq - 1u;
+            if (__atomic_compare_exchange_n(&p->cursor, &prev, r->seq, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) break;
+        }
+        errcheck_read_end_(&g_errcheck_plan_readers, epoch);
+    }
+
+    /* The site id is only computed once a plan is armed */
+    #define ERRCHECK_INJECTED_(site, err_flag)                             \
+        (ERRCHECK_INJECT_FLAG_(err_flag) ||                                \
+         (errcheck_plan_armed_() && errcheck_plan_injected_((site), (uint32_t)(err_flag))))
+
+    #define ERRCHECK_PLAN_FAILED_(site, err_flag)                          \
+        (errcheck_plan_armed_() ? errcheck_plan_failed_((site), (uint32_t)(err_flag)) : (void)0)
+#else
+    #define ERRCHECK_INJECTED_(site, err_flag) ERRCHECK_INJECT_FLAG_(err_flag)
+    #define ERRCHECK_PLAN_FAILED_(site, err_flag) ((void)0)
+#endif
+
+/* True when the check failed by itself or is injected; the plan only sees a
+   natural failure (to advance replay), injection only a passing check */
+#define ERRCHECK_FAILED_OR_INJECTED_(failed, site, err_flag)               \
+    ((failed) ? (ERRCHECK_PLAN_FAILED_(site, err_flag), 1)                 \
+              : ERRCHECK_INJECTED_(site, err_flag))
+
+/* ========================================================================= */
+/* Optional: Hot-Reloadable Injection Config (Linux, inotify)                */
+/* ========================================================================= */
+/* A watcher thread parses a plain-text plan file at start and after every
+ * save, then publishes the new plan atomically. A file that fails to parse
+ * is ignored — the previous plan stays armed. An empty file disarms.
+ *
+ *     # one rule per line, '#' comments
+ *     # keys: err site after count thread scope start end period duty seq
+ *     err=3   site=0  after=10  count=1
+ *     err=5   thread=2 scope=4
+ *     err=7   period=1000 duty=200         # 200 ms outage every second
+ *     err=2   site=118 seq=1               # replay: site 118 fails first,
+ *     err=4   site=57  seq=2               #   then site 57 (tools/trace2plan.py)
+ *
+ * With ERRCHECK_ENABLE_CHECK_LEVELS the same file also carries check levels:
+ *
+ *     levels=0x5                           # levels 1 and 3 on
+ *     site=0x5D1C0A7E enable=0             # ... but not this CHECK_LEVEL
+ *
+ * A file with any level line replaces the level configuration (mask 0 unless
+ * 'levels' is given); a file without one leaves it as it is.
+ *
+ *     errcheck_reload_start("/tmp/inject.conf");   // → 0 on success
+ *     ...
+ *     errcheck_reload_stop();                      // joins, frees old plans
+ *
+ * A replaced plan is freed once no CHECK that could have loaded it is still
+ * reading it (g_errcheck_plan_readers; likewise level configurations). The
+ * watcher checks every ERRCHECK_RELOAD_POLL_MS while something waits, so a
+ * reader stopped in a debugger only delays the free. At most
+ * ERRCHECK_RELOAD_MAX_PLANS plans are live or waiting; a save beyond that is
+ * rejected with a message on stderr.
+ *
+ * The watcher state is file-local: call start/stop from the same .c file.
+ * Compile with -D_GNU_SOURCE and link with -lpthread.
+ */
+#ifdef ERRCHECK_ENABLE_INJECTION_RELOAD
+    #ifndef ERRCHECK_ENABLE_INJECTION_PLAN
+        #error "ERRCHECK_ENABLE_INJECTION_RELOAD requires ERRCHECK_ENABLE_INJECTION_PLAN"
+    #endif
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <string.h>
+    #include <pthread.h>
+    #include <unistd.h>
+    #include <sys/select.h>
+    #include <sys/inotify.h>
+
+    #ifndef ERRCHECK_RELOAD_MAX_RULES
+        #define ERRCHECK_RELOAD_MAX_RULES 256
+    #endif
+    #ifndef ERRCHECK_RELOAD_MAX_PLANS
+        #define ERRCHECK_RELOAD_MAX_PLANS 256   /* live + waiting for readers */
+    #endif
+    #ifndef ERRCHECK_RELOAD_POLL_MS
+        #define ERRCHECK_RELOAD_POLL_MS 100     /* reader check while a free waits */
+    #endif
+
+    /* Allocations the watcher published; freed once replaced and unread */
+    typedef struct {
+        errcheck_readers_t *readers;
+        void               *ptr[ERRCHECK_RELOAD_MAX_PLANS];
+        uint32_t            epoch[ERRCHECK_RELOAD_MAX_PLANS];      /* replaced during */
+        uint8_t             replaced[ERRCHECK_RELOAD_MAX_PLANS];   /* 0 = still published */
+        uint32_t            n;
+    } errcheck_retired_t;
+
+    /* Returns the newest epoch no reader is still inside; with 'advance' also
+       moves readers on to the next epoch. The epoch only advances once the
+       parity it reuses is empty, so every older epoch has drained as well. */
+    static inline uint32_t errcheck_readers_drained_(errcheck_readers_t *rd, int advance)
+    {
+        uint32_t e = __atomic_load_n(&rd->epoch, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&rd->active[(e - 1u) & 1u], __ATOMIC_SEQ_CST) != 0) return e - 2u;
+        if (advance) __atomic_store_n(&rd->epoch, e + 1u, __ATOMIC_SEQ_CST);
+        return e - 1u;
+    }
+
+    /* Frees what no reader can still see; returns how many replaced
+       allocations are left waiting */
+    static inline uint32_t errcheck_retired_reclaim_(errcheck_retired_t *r)
+    {
+        uint32_t i, n = 0, waiting = 0, done;
+        for (i = 0; i < r->n; i++) waiting += r->replaced[i];
+        if (!waiting) return 0;
+
+        done = errcheck_readers_drained_(r->readers, 1);
+        waiting = 0;
+        for (i = 0; i < r->n; i++) {
+            if (r->replaced[i] && (int32_t)(r->epoch[i] - done) <= 0) {
+                free(r->ptr[i]);
+                continue;
+            }
+            waiting += r->replaced[i];
+            r->ptr[n]      = r->ptr[i];
+            r->epoch[n]    = r->epoch[i];
+            r->replaced[n] = r->replaced[i];
+            n++;
+        }
+        r->n = n;
+        return waiting;
+    }
+
+    /* Marks 'old' (if the watcher owns it) replaced in the current epoch;
+       call after the exchange that unpublished it */
+    static inline void errcheck_retired_replaced_(errcheck_retired_t *r, void *old)
+    {
+        uint32_t i, e = __atomic_load_n(&r->readers->epoch, __ATOMIC_SEQ_CST);
+        for (i = 0; i < r->n; i++) {
+            if (r->ptr[i] == old && !r->replaced[i]) { r->epoch[i] = e; r->replaced[i] = 1; }
+        }
+    }
+
+    static inline void errcheck_retired_add_(errcheck_retired_t *r, void *p)
+    {
+        r->ptr[r->n]      = p;
+        r->replaced[r->n] = 0;
+        r->n++;
+    }
+
+    typedef struct {
+        char                    path[256];
+        int                     fd;             /* inotify instance */
+        int                     stop_pipe[2];
+        pthread_t               thread;
+        errcheck_retired_t      plans;
+    #ifdef ERRCHECK_ENABLE_CHECK_LEVELS
+        errcheck_retired_t      levels;
+    #endif
+        uint32_t                reloads;        /* successful parses */
+        uint32_t                rejects;        /* saves not applied (parse error, full) */
+    } errcheck_reload_t;
+
+    static errcheck_reload_t errcheck_reload_;
+
+    /* Parses one "key=value ..." line into 'r'; returns 1 rule, 0 blank, -1 error */
+    static inline int errcheck_inject_parse_line(char *line, errcheck_inject_rule_t *r)
+    {
+        char *tok, *save = 0;
+        int have_err = 0, any = 0, level = 0;
+
+        if ((tok = strchr(line, '#')) != 0) *tok = '\0';
+        memset(r, 0, sizeof *r);
+        for (tok = strtok_r(line, " \t\r\n", &save); tok; tok = strtok_r(0, " \t\r\n", &save)) {
+            char *eq = strchr(tok, '='), *end;
+            unsigned long v;
+            any = 1;
+            if (!eq) return -1;
+            *eq = '\0';
+            v = strtoul(eq + 1, &end, 0);
+            if (*end != '\0' || end == eq + 1) return -1;
+            if      (!strcmp(tok, "err"))   { r->err = (uint32_t)v; have_err = 1; }
+            else if (!strcmp(tok, "site"))  r->site  = (uint32_t)v;
+            else if (!strcmp(tok, "after")) r->after = (uint32_t)v;
+            else if (!strcmp(tok, "count")) r->count = (uint32_t)v;
+            else if (!strcmp(tok, "thread")) r->thread = (uint32_t)v;
+            else if (!strcmp(tok, "scope") && v <= 32) r->scope = (uint32_t)v;
+            else if (!strcmp(tok, "start"))  r->start  = (uint32_t)v;
+            else if (!strcmp(tok, "end"))    r->end    = (uint32_t)v;
+            else if (!strcmp(tok, "period")) r->period = (uint32_t)v;
+            else if (!strcmp(tok, "duty"))   r->duty   = (uint32_t)v;
+            else if (!strcmp(tok, "seq"))    r->seq    = (uint32_t)v;
+    #ifdef ERRCHECK_ENABLE_CHECK_LEVELS
+            else if (!strcmp(tok, "levels") || !strcmp(tok, "enable")) level = 1;
+    #endif
+            else return -1;
+        }
+        if (!any) return 0;
+        if (level) return have_err ? -1 : 0;    /* errcheck_levels_load's line */
+        return have_err ? 1 : -1;
+    }
+
+    /* Loads a whole file; returns 1 and sets *out (NULL if empty) or 0 on error */
+    static inline int errcheck_inject_load(const char *path, errcheck_inject_plan_t **out)
+    {
+        errcheck_inject_rule_t rules[ERRCHECK_RELOAD_MAX_RULES];
+        errcheck_inject_plan_t *p;
+        char line[256];
+        uint32_t n = 0;
+        FILE *f = fopen(path, "r");
+
+        if (!f) return 0;
+        while (fgets(line, sizeof line, f)) {
+            int rc;
+            if (n == ERRCHECK_RELOAD_MAX_RULES) { fclose(f); return 0; }
+            rc = errcheck_inject_parse_line(line, &rules[n]);
+            if (rc < 0) { fclose(f); return 0; }
+            n += (uint32_t)rc;
+        }
+        fclose(f);
+
+        *out = 0;
+        if (n == 0) return 1;
+        p = (errcheck_inject_plan_t *)malloc(sizeof *p + n * sizeof rules[0]);
+        if (!p) return 0;
+        p->n      = n;
+        p->rule   = (errcheck_inject_rule_t *)(p + 1);
+        p->cursor = 0;
+        p->seen   = 0;
+        memcpy(p->rule, rules, n * sizeof rules[0]);
+        *out = p;
+        return 1;
+    }
+
+#ifdef ERRCHECK_ENABLE_CHECK_LEVELS
+    /* Parses a level line: 1 = 'levels' mask, 2 = site override, 0 = not a
+       level line, -1 = malformed */
+    static inline int errcheck_levels_parse_line_(char *line, uint32_t *mask,
+                                                  errcheck_level_override_t *o)
+    {
+        char *tok, *save = 0;
+        int have_mask = 0, have_enable = 0, have_site = 0, other = 0;
+        uint32_t m = 0;
+
+        if ((tok = strchr(line, '#')) != 0) *tok = '\0';
+        memset(o, 0, sizeof *o);
+        for (tok = strtok_r(line, " \t\r\n", &save); tok; tok = strtok_r(0, " \t\r\n", &save)) {
+            char *eq = strchr(tok, '='), *end;
+            unsigned long v;
+            if (!eq) return -1;
+            *eq = '\0';
+            v = strtoul(eq + 1, &end, 0);
+            if (*end != '\0' || end == eq + 1) return -1;
+            if      (!strcmp(tok, "levels")) { m = (uint32_t)v; have_mask = 1; }
+            else if (!strcmp(tok, "enable")) { o->on = v != 0; have_enable = 1; }
+            else if (!strcmp(tok, "site"))   { o->site = (uint32_t)v; have_site = 1; }
+            else other = 1;
+        }
+        if (have_mask) {
+            if (have_enable || have_site || other) return -1;
+            *mask = m;
+            return 1;
+        }
+        if (have_enable) return have_site && !other ? 2 : -1;
+        return 0;
+    }
+
+    /* Loads the level lines of a file; returns 1 and sets *out (NULL if the
+       file has none) or 0 on error */
+    static inline int errcheck_levels_load(const char *path, errcheck_levels_t **out)
+    {
+        errcheck_level_override_t site[ERRCHECK_RELOAD_MAX_RULES];
+        errcheck_levels_t *lv;
+        char line[256];
+        uint32_t mask = 0, n = 0;
+        int any = 0;
+        FILE *f = fopen(path, "r");
+
+        if (!f) return 0;
+        while (fgets(line, sizeof line, f)) {
+            int rc;
+            if (n == ERRCHECK_RELOAD_MAX_RULES) { fclose(f); return 0; }
+            rc = errcheck_levels_parse_line_(line, &mask, &site[n]);
+            if (rc < 0) { fclose(f); return 0; }
+            any |= rc;
+            n += rc == 2;
+        }
+        fclose(f);
+
+        *out = 0;
+        if (!any) return 1;
+        lv = (errcheck_levels_t *)malloc(sizeof *lv + n * sizeof site[0]);
+        if (!lv) return 0;
+        lv->mask = mask;
+        lv->n    = n;
+        lv->site = (errcheck_level_override_t *)(lv + 1);
+        memcpy(lv->site, site, n * sizeof site[0]);
+        *out = lv;
+        return 1;
+    }
+#endif
+
+    static inline void errcheck_reload_once_(errcheck_reload_t *w)
+    {
+        errcheck_inject_plan_t *p, *old;
+
+        if (!errcheck_inject_load(w->path, &p)) { w->rejects++; return; }
+        errcheck_retired_reclaim_(&w->plans);
+        if (p && w->plans.n == ERRCHECK_RELOAD_MAX_PLANS) {
+            fprintf(stderr, "errcheck: %s not applied: %u plans still live or being read\n",
+                    w->path, (unsigned)w->plans.n);
+            free(p);
+            w->rejects++;
+            return;
+        }
+    #ifdef ERRCHECK_ENABLE_CHECK_LEVELS
+        {
+            errcheck_levels_t *lv = 0;
+            errcheck_retired_reclaim_(&w->levels);
+            if (!errcheck_levels_load(w->path, &lv)) { free(p); w->rejects++; return; }
+            if (lv && w->levels.n == ERRCHECK_RELOAD_MAX_PLANS) {
+                fprintf(stderr, "errcheck: %s not applied: %u level configurations "
+                        "still live or being read\n", w->path, (unsigned)w->levels.n);
+                free(lv); free(p); w->rejects++; return;
+            }
+            if (lv) {
+                errcheck_retired_replaced_(&w->levels, errcheck_levels_publish(lv));
+                errcheck_retired_add_(&w->levels, lv);
+            }
+        }
+    #endif
+        old = errcheck_inject_publish(p);
+        errcheck_retired_replaced_(&w->plans, old);
+        if (p) errcheck_retired_add_(&w->plans, p);
+        w->reloads++;
+    }
+
+    /* Frees what became unreachable; returns nonzero while anything waits */
+    static inline uint32_t errcheck_reload_reclaim_(errcheck_reload_t *w)
+    {
+        uint32_t waiting = errcheck_retired_reclaim_(&w->plans);
+    #ifdef ERRCHECK_ENABLE_CHECK_LEVELS
+        waiting += errcheck_retired_reclaim_(&w->levels);
+    #endif
+        return waiting;
+    }
+
+    static inline void *errcheck_reload_thread_(void *arg)
+    {
+        errcheck_reload_t *w = (errcheck_reload_t *)arg;
+        const char *base = strrchr(w->path, '/');
+        char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+        base = base ? base + 1 : w->path;
+
+        for (;;) {
+            fd_set rd;
+            ssize_t len;
+            char *q;
+            int changed = 0, ready;
+            struct timeval tick = { ERRCHECK_RELOAD_POLL_MS / 1000,
+                                    (ERRCHECK_RELOAD_POLL_MS % 1000) * 1000 };
+
+            FD_ZERO(&rd);
+            FD_SET(w->fd, &rd);
+            FD_SET(w->stop_pipe[0], &rd);
+            ready = select((w->fd > w->stop_pipe[0] ? w->fd : w->stop_pipe[0]) + 1, &rd, 0, 0,
+                           errcheck_reload_reclaim_(w) ? &tick : 0);
+            if (ready <= 0) continue;
+            if (FD_ISSET(w->stop_pipe[0], &rd)) break;
+
+            len = read(w->fd, buf, sizeof buf);
+            for (q = buf; len > 0 && q < buf + len; ) {
+                const struct inotify_event *ev = (const struct inotify_event *)q;
+                if (ev->len && !strcmp(ev->name, base)) changed = 1;
+                q += sizeof *ev + ev->len;
+            }
+            if (changed) errcheck_reload_once_(w);
+        }
+        return 0;
+    }
+
+    /* Loads the file now and watches it; returns 0 on success */
+    static inline int errcheck_reload_start(const char *path)
+    {
+        errcheck_reload_t *w = &errcheck_reload_;
+        char dir[256];
+        const char *slash = strrchr(path, '/');
+
+        if (strlen(path) >= sizeof w->path) return -1;
+        strcpy(w->path, path);
+        w->plans.readers = &g_errcheck_plan_readers;
+    #ifdef ERRCHECK_ENABLE_CHECK_LEVELS
+        w->levels.readers = &g_errcheck_level_readers;
+    #endif
+        if (!slash)             strcpy(dir, ".");
+        else if (slash == path) strcpy(dir, "/");
+        else { memcpy(dir, path, (size_t)(slash - path)); dir[slash - path] = '\0'; }
+
+        /* Watch the directory: editors save by replacing the file */
+        if ((w->fd = inotify_init1(IN_CLOEXEC)) < 0) return -1;
+        if (inotify_add_watch(w->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO) < 0 ||
+            pipe(w->stop_pipe) != 0) {
+            close(w->fd);
+            return -1;
+        }
+        errcheck_reload_once_(w);
+        if (pthread_create(&w->thread, 0, errcheck_reload_thread_, w) != 0) {
+            close(w->fd); close(w->stop_pipe[0]); close(w->stop_pipe[1]);
+            return -1;
+        }
+        return 0;
+    }
+
+    /* Stops the watcher, disarms injection and frees every plan it loaded
+       (and every level configuration except the active one).
+       Call only when no CHECK can still be running on another thread. */
+    static inline void errcheck_reload_stop(void)
+    {
+        errcheck_reload_t *w = &errcheck_reload_;
+        uint32_t i;
+        char c = 0;
+
+        if (write(w->stop_pipe[1], &c, 1) == 1) pthread_join(w->thread, 0);
+        close(w->fd); close(w->stop_pipe[0]); close(w->stop_pipe[1]);
+        (void)errcheck_inject_publish(0);
+        for (i = 0; i < w->plans.n; i++) free(w->plans.ptr[i]);
+        w->plans.n = 0;
+    #ifdef ERRCHECK_ENABLE_CHECK_LEVELS
+        /* The active level configuration stays in effect */
+        for (i = 0; i < w->levels.n; i++) {
+            if (w->levels.ptr[i] != __atomic_load_n(&g_errcheck_levels, __ATOMIC_ACQUIRE))
+                free(w->levels.ptr[i]);
+        }
+        w->levels.n = 0;
+    #endif
+    }
+#endif
+
+/* ========================================================================= */
+/* Independent Error Domains                                                 */
+/* ========================================================================= */
+/* A library that uses errcheck.h must not share err_t, ERR_FAILURE or
+ * g_last_error with the application. Each domain gets its own type,
+ * failure sentinel, last-error state, injection flag and failure counter.
+ * Everything is resolved at compile time — no tables, no indirection.
+ *
+ * In the library's public header:
+ *     ERRCHECK_DECLARE_DOMAIN(net, uint16_t, 0xFFFF)
+ *
+ * In exactly one of the library's .c files:
+ *     ERRCHECK_DEFINE_DOMAIN(net)
+ *
+ * Then:
+ *     net_err_t net_open(void)
+ *     {
+ *         CHECK_IN(net, phy_up(), NET_ERR_PHY);
+ *         return 0;
+ *     }
+ *
+ * Domain checks honour ERRCHECK_ENABLE_RUNTIME_INJECTION (per-domain flag
+ * <dom>_inject_error_flag) but not the default domain's reporting hooks.
+ */
+#define ERRCHECK_DECLARE_DOMAIN(dom, type, failure)                         \
+    typedef type dom##_err_t;                                              \
+    static inline dom##_err_t dom##_failure(void) { return (dom##_err_t)(failure); } \
+    extern dom##_err_t dom##_last_error;                                   \
+    extern volatile dom##_err_t dom##_inject_error_flag;                   \
+    extern uint32_t dom##_failure_count;
+
+#define ERRCHECK_DEFINE_DOMAIN(dom)                                        \
+    dom##_err_t dom##_last_error;                                          \
+    volatile dom##_err_t dom##_inject_error_flag;                          \
+    uint32_t dom##_failure_count;
+
+#ifdef ERRCHECK_ENABLE_RUNTIME_INJECTION
+    #define ERRCHECK_DOMAIN_INJECTED_(dom, err_flag)                       \
+        (dom##_inject_error_flag == (err_flag) && (dom##_inject_error_flag = 0, 1))
+#else
+    #define ERRCHECK_DOMAIN_INJECTED_(dom, err_flag) 0
+#endif
+
+#define CHECK_IN(dom, call, err_flag) do {                                 \
+    if ((call) == 0 || ERRCHECK_DOMAIN_INJECTED_(dom, err_flag)) {         \
+        dom##_last_error = (err_flag);                                     \
+        __atomic_fetch_add(&dom##_failure_count, 1, __ATOMIC_RELAXED);     \
+        return dom##_failure();                                            \
+    }                                                                      \
+} while (0)
+
+#define RETURN_ERR_IN(dom, err_flag) do {                                  \
+    dom##_last_error = (err_flag);                                         \
+    __atomic_fetch_add(&dom##_failure_count, 1, __ATOMIC_RELAXED);         \
+    return dom##_failure();                                                \
+} while (0)
+
 /* ========================================================================= */
 /* Optional: Error Logging                                                   */
 /* ========================================================================= */
@@ -69,4 +1223,1545 @@ extern err_t g_last_error;
     #define ERR_LOG(...)
 #endif
 
+/* ========================================================================= */
+/* Optional: Freestanding Reporting (no stdio, no printf)                    */
+/* ========================================================================= */
+/* Both modes write through one user-supplied byte sink:
+ *
+ *     void errcheck_putc(char c) { UART0->DR = c; }   // or ITM, RTT, ...
+ *
+ * ERRCHECK_ENABLE_SINK_LOGGING  : text line "E<site>:<err>\n" per failure
+ * ERRCHECK_ENABLE_TOKEN_LOGGING : 7-byte binary record per failure
+ *                                 [0xEC][site u32 LE][err u16 LE]
+ *
+ * Aggregated records (see ERRCHECK_ENABLE_DEDUP) carry a count:
+ *     text  "E<site>:<err>x<count>\n"    token  [0xED][site][err][count u32 LE]
+ */
+#if defined(ERRCHECK_ENABLE_SINK_LOGGING) || defined(ERRCHECK_ENABLE_TOKEN_LOGGING) || \
+    defined(ERRCHECK_ENABLE_PROFILE) || defined(ERRCHECK_ENABLE_FLAME)
+    #define ERRCHECK_HAS_PUTC_
+#endif
+
+#ifdef ERRCHECK_HAS_PUTC_
+    extern void errcheck_putc(char c);
+
+    static inline void errcheck_put_str(const char *s)
+    {
+        while (*s) errcheck_putc(*s++);
+    }
+
+    /* Tiny unsigned formatter: no division tables, no printf */
+    static inline void errcheck_put_u32(uint32_t v)
+    {
+        char buf[10];
+        uint8_t n = 0;
+        do { buf[n++] = (char)('0' + v % 10u); v /= 10u; } while (v);
+        while (n) errcheck_putc(buf[--n]);
+    }
+
+    static inline void errcheck_put_u64(uint64_t v)
+    {
+        char buf[20];
+        uint8_t n = 0;
+        do { buf[n++] = (char)('0' + v % 10u); v /= 10u; } while (v);
+        while (n) errcheck_putc(buf[--n]);
+    }
+
+    static inline void errcheck_put_hex_(uintptr_t v)
+    {
+        char buf[2 * sizeof(uintptr_t)];
+        uint8_t n = 0;
+        do { buf[n++] = "0123456789abcdef"[v & 0xFu]; v >>= 4; } while (v);
+        errcheck_put_str("0x");
+        while (n) errcheck_putc(buf[--n]);
+    }
+
+    static inline void errcheck_put_le_(uint32_t v, uint8_t bytes)
+    {
+        while (bytes--) { errcheck_putc((char)(v & 0xFFu)); v >>= 8; }
+    }
+#endif
+
+#if defined(ERRCHECK_ENABLE_TOKEN_LOGGING)
+    #define ERRCHECK_TOKEN_SYNC       0xEC
+    #define ERRCHECK_TOKEN_SYNC_COUNT 0xED   /* followed by count u32 LE */
+#endif
+
+#if defined(ERRCHECK_ENABLE_SINK_LOGGING) || defined(ERRCHECK_ENABLE_TOKEN_LOGGING)
+    #define ERRCHECK_HAS_SINK_
+#endif
+
+/* Delivers one record (count > 1 when aggregated) to every enabled sink */
+static inline void errcheck_emit_(uint32_t site, uint32_t err, uint32_t count)
+{
+#if defined(ERRCHECK_ENABLE_TOKEN_LOGGING)
+    errcheck_putc((char)(count == 1 ? ERRCHECK_TOKEN_SYNC : ERRCHECK_TOKEN_SYNC_COUNT));
+    errcheck_put_le_(site, 4);
+    errcheck_put_le_(err, 2);
+    if (count != 1) errcheck_put_le_(count, 4);
+#elif defined(ERRCHECK_ENABLE_SINK_LOGGING)
+    errcheck_putc('E');
+    errcheck_put_u32(site);
+    errcheck_putc(':');
+    errcheck_put_u32(err);
+    if (count != 1) { errcheck_putc('x'); errcheck_put_u32(count); }
+    errcheck_putc('\n');
+#endif
+    (void)site; (void)err; (void)count;
+}
+
+/* ========================================================================= */
+/* Lock-Free Slot Claim (shared by the fixed tables below)                   */
+/* ========================================================================= */
+/* A slot goes EMPTY -> CLAIMING -> READY and never reverts (dedup slots are
+   the exception: errcheck_dedup_flush() recycles idle ones). Returns OWNED if
+   the caller won an empty slot (fill it, then publish READY), otherwise the
+   state it saw; CLAIMING slots are skipped, never waited on. Only built when
+   a table uses it, so default builds need no atomics. */
+#if defined(ERRCHECK_ENABLE_DEDUP) || defined(ERRCHECK_ENABLE_PROFILE) || \
+    defined(ERRCHECK_ENABLE_FLAME)
+#define ERRCHECK_SLOT_EMPTY_    0u
+#define ERRCHECK_SLOT_CLAIMING_ 1u
+#define ERRCHECK_SLOT_READY_    2u
+#define ERRCHECK_SLOT_OWNED_    3u
+
+static inline uint32_t errcheck_slot_claim_(uint32_t *state)
+{
+    uint32_t st = __atomic_load_n(state, __ATOMIC_ACQUIRE);
+    if (st == ERRCHECK_SLOT_EMPTY_ &&
+        __atomic_compare_exchange_n(state, &st, ERRCHECK_SLOT_CLAIMING_, 0,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        return ERRCHECK_SLOT_OWNED_;
+    return st;
+}
+
+static inline void errcheck_slot_publish_(uint32_t *state)
+{
+    __atomic_store_n(state, ERRCHECK_SLOT_READY_, __ATOMIC_RELEASE);
+}
+#endif
+
+/* ========================================================================= */
+/* Optional: Deduplication Cache (in front of all sinks)                     */
+/* ========================================================================= */
+/* Identical failures (same site, same code) inside one window are counted in
+ * a small lock-free table instead of being emitted one by one. One record with
+ * the exact count is emitted when the window closes — either by the next
+ * duplicate or by errcheck_dedup_flush() from the idle loop.
+ *
+ *     errcheck_dedup_slot_t g_errcheck_dedup[ERRCHECK_DEDUP_SLOTS];
+ *
+ * Needs 32-bit atomics only (GCC/Clang __atomic builtins); safe from ISRs.
+ * When the table is full the record bypasses the cache, so totals stay exact.
+ * A flush reclaims slots that saw no failure for a whole window, so the table
+ * tracks the failures of the moment rather than the first ones ever seen.
+ */
+#ifdef ERRCHECK_ENABLE_DEDUP
+    #ifndef ERRCHECK_DEDUP_SLOTS
+        #define ERRCHECK_DEDUP_SLOTS     16      /* power of two */
+    #endif
+    #ifndef ERRCHECK_DEDUP_WINDOW_MS
+        #define ERRCHECK_DEDUP_WINDOW_MS 1000
+    #endif
+
+    typedef struct {
+        uint32_t state;          /* errcheck_slot_claim_ */
+        uint32_t site;
+        uint32_t err;
+        uint32_t window_start;   /* ms */
+        uint32_t count;          /* generation << 24 | failures in the current window */
+    } errcheck_dedup_slot_t;
+
+    /* Every owner of a slot gets the next generation, so an exchange on
+       'count' fails if the slot was recycled since the count was read (unless
+       it was recycled a multiple of 256 times in between). A
+       window counts up to 0xFFFFFE failures; the all-ones count marks a slot
+       being reclaimed, and no recorder may add to it. */
+    #define ERRCHECK_DEDUP_COUNT_   0x00FFFFFFu
+    #define ERRCHECK_DEDUP_GEN_     0xFF000000u
+    #define ERRCHECK_DEDUP_RETIRED_ ERRCHECK_DEDUP_COUNT_
+
+    extern errcheck_dedup_slot_t g_errcheck_dedup[ERRCHECK_DEDUP_SLOTS];
+
+    /* Closes the slot's window if it started at 'start'; one caller wins */
+    static inline void errcheck_dedup_close_(errcheck_dedup_slot_t *s,
+                                             uint32_t start, uint32_t now)
+    {
+        if (__atomic_compare_exchange_n(&s->window_start, &start, now, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            uint32_t c = __atomic_load_n(&s->count, __ATOMIC_ACQUIRE), n;
+            while ((n = c & ERRCHECK_DEDUP_COUNT_) != ERRCHECK_DEDUP_RETIRED_ &&
+                   !__atomic_compare_exchange_n(&s->count, &c, c & ERRCHECK_DEDUP_GEN_, 0,
+                                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) { }
+            if (n != 0 && n != ERRCHECK_DEDUP_RETIRED_) errcheck_emit_(s->site, s->err, n);
+        }
+    }
+
+    /* Adds one failure unless the slot is being reclaimed. 'gen' is the
+       generation read before the key was compared: once the slot has been
+       recycled the add gives up instead of counting under the new key. A full
+       count is emitted early and the window restarts with this failure. */
+    static inline int errcheck_dedup_add_(errcheck_dedup_slot_t *s, uint32_t c, uint32_t gen,
+                                          uint32_t site, uint32_t err)
+    {
+        while ((c & ERRCHECK_DEDUP_GEN_) == gen &&
+               (c & ERRCHECK_DEDUP_COUNT_) != ERRCHECK_DEDUP_RETIRED_) {
+            uint32_t full = (c & ERRCHECK_DEDUP_COUNT_) == ERRCHECK_DEDUP_RETIRED_ - 1u;
+            if (__atomic_compare_exchange_n(&s->count, &c, full ? gen | 1u : c + 1u, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                if (full) errcheck_emit_(site, err, ERRCHECK_DEDUP_RETIRED_ - 1u);
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    static inline void errcheck_dedup_record_(uint32_t site, uint32_t err)
+    {
+        uint32_t now = ERRCHECK_NOW_MS();
+        uint32_t i   = (site * 0x9E3779B1u ^ err) & (ERRCHECK_DEDUP_SLOTS - 1);
+        uint32_t probe;
+
+        for (probe = 0; probe < ERRCHECK_DEDUP_SLOTS; probe++, i = (i + 1) & (ERRCHECK_DEDUP_SLOTS - 1)) {
+            errcheck_dedup_slot_t *s = &g_errcheck_dedup[i];
+            uint32_t c  = __atomic_load_n(&s->count, __ATOMIC_ACQUIRE);
+            uint32_t st = errcheck_slot_claim_(&s->state);
+
+            if (st == ERRCHECK_SLOT_OWNED_) {
+                uint32_t gen = __atomic_load_n(&s->count, __ATOMIC_RELAXED) & ERRCHECK_DEDUP_GEN_;
+                s->site = site;
+                s->err  = err;
+                __atomic_store_n(&s->window_start, now, __ATOMIC_RELAXED);
+                __atomic_store_n(&s->count, (gen + 0x01000000u) | 1u, __ATOMIC_RELEASE);
+                errcheck_slot_publish_(&s->state);
+                return;
+            }
+            if (st == ERRCHECK_SLOT_READY_ && s->site == site && s->err == err) {
+                uint32_t gen   = c & ERRCHECK_DEDUP_GEN_;
+                uint32_t start = __atomic_load_n(&s->window_start, __ATOMIC_ACQUIRE);
+                if ((uint32_t)(now - start) >= ERRCHECK_DEDUP_WINDOW_MS) {
+                    errcheck_dedup_close_(s, start, now);
+                    c = __atomic_load_n(&s->count, __ATOMIC_ACQUIRE);
+                }
+                if (errcheck_dedup_add_(s, c, gen, site, err)) return;
+            }
+        }
+        errcheck_emit_(site, err, 1);   /* table full: bypass, never drop */
+    }
+
+    /* Emits every window that has closed; force != 0 emits all pending counts.
+       A slot with nothing counted since its last window closed is reclaimed. */
+    static inline void errcheck_dedup_flush(int force)
+    {
+        uint32_t now = ERRCHECK_NOW_MS();
+        uint32_t i;
+        for (i = 0; i < ERRCHECK_DEDUP_SLOTS; i++) {
+            errcheck_dedup_slot_t *s = &g_errcheck_dedup[i];
+            uint32_t start, idle;
+            if (__atomic_load_n(&s->state, __ATOMIC_ACQUIRE) != ERRCHECK_SLOT_READY_) continue;
+            start = __atomic_load_n(&s->window_start, __ATOMIC_ACQUIRE);
+            if (!force && (uint32_t)(now - start) < ERRCHECK_DEDUP_WINDOW_MS) continue;
+            idle = __atomic_load_n(&s->count, __ATOMIC_ACQUIRE) & ERRCHECK_DEDUP_GEN_;
+            if (__atomic_compare_exchange_n(&s->count, &idle, idle | ERRCHECK_DEDUP_RETIRED_, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+                __atomic_store_n(&s->state, ERRCHECK_SLOT_EMPTY_, __ATOMIC_RELEASE);
+            else
+                errcheck_dedup_close_(s, start, now);
+        }
+    }
+
+    #define ERRCHECK_REPORT_(site, err_flag)                               \
+        errcheck_dedup_record_((site), (uint32_t)(err_flag))
+#elif defined(ERRCHECK_HAS_SINK_)
+    #define ERRCHECK_REPORT_(site, err_flag)                               \
+        errcheck_emit_((site), (uint32_t)(err_flag), 1)
+#else
+    #define ERRCHECK_REPORT_(site, err_flag) ((void)0)
+#endif
+
+/* ========================================================================= */
+/* Optional: Hierarchical Subsystem Rollups                                  */
+/* ========================================================================= */
+/* Declare the subsystem tree once, at compile time. The first node is the
+ * root; every other node names a parent declared before it.
+ *
+ *     #define ERRCHECK_NODES(X)        \
+ *         X(NODE_BOARD, NODE_BOARD)    \
+ *         X(NODE_BUS,   NODE_BOARD)    \
+ *         X(NODE_POWER, NODE_BOARD)
+ *
+ *     #define ERRCHECK_CODE_NODES(X)   \
+ *         X(ERR_I2C,  NODE_BUS)        \
+ *         X(ERR_SPI,  NODE_BUS)        \
+ *         X(ERR_UART, NODE_BUS)
+ *
+ *     uint32_t g_errcheck_node_self[ERRCHECK_NODE_COUNT];    // failures at node
+ *     uint32_t g_errcheck_node_total[ERRCHECK_NODE_COUNT];   // node + subtree
+ *
+ * A failure bumps its node and every ancestor (O(depth), lock-free), so a
+ * rollup query is a single load. Unmapped codes are counted at the root.
+ */
+#ifdef ERRCHECK_ENABLE_ROLLUPS
+    #if !defined(ERRCHECK_NODES) || !defined(ERRCHECK_CODE_NODES)
+        #error "ERRCHECK_ENABLE_ROLLUPS requires ERRCHECK_NODES and ERRCHECK_CODE_NODES"
+    #endif
+
+    #define ERRCHECK_NODE_ENUM_(node, parent)   node,
+    #define ERRCHECK_NODE_PARENT_(node, parent) (uint8_t)(parent),
+    #define ERRCHECK_NODE_NAME_(node, parent)   #node,
+    #define ERRCHECK_NODE_ORDER_(node, parent)                             \
+        typedef char errcheck_parent_declared_before_##node[((parent) <= (node)) ? 1 : -1];
+    #define ERRCHECK_CODE_CASE_(code, node)     case (code): return (uint8_t)(node);
+
+    enum { ERRCHECK_NODES(ERRCHECK_NODE_ENUM_) ERRCHECK_NODE_COUNT };
+    ERRCHECK_NODES(ERRCHECK_NODE_ORDER_)
+
+    static const uint8_t errcheck_node_parent_[ERRCHECK_NODE_COUNT] = {
+        ERRCHECK_NODES(ERRCHECK_NODE_PARENT_)
+    };
+    static const char *const errcheck_node_name_[ERRCHECK_NODE_COUNT] = {
+        ERRCHECK_NODES(ERRCHECK_NODE_NAME_)
+    };
+
+    extern uint32_t g_errcheck_node_self[ERRCHECK_NODE_COUNT];
+    extern uint32_t g_errcheck_node_total[ERRCHECK_NODE_COUNT];
+
+    static inline uint8_t errcheck_node_of(uint32_t err)
+    {
+        switch (err) {
+            ERRCHECK_CODE_NODES(ERRCHECK_CODE_CASE_)
+            default: return 0;
+        }
+    }
+
+    static inline void errcheck_rollup_record_(uint32_t err)
+    {
+        uint8_t n = errcheck_node_of(err);
+        __atomic_fetch_add(&g_errcheck_node_self[n], 1, __ATOMIC_RELAXED);
+        for (;;) {
+            __atomic_fetch_add(&g_errcheck_node_total[n], 1, __ATOMIC_RELAXED);
+            if (errcheck_node_parent_[n] == n) break;
+            n = errcheck_node_parent_[n];
+        }
+    }
+
+    /* Queries for dashboards: O(1) totals, drill down via errcheck_node_parent() */
+    static inline uint32_t errcheck_rollup(uint8_t node)     { return __atomic_load_n(&g_errcheck_node_total[node], __ATOMIC_RELAXED); }
+    static inline uint32_t errcheck_node_count(uint8_t node) { return __atomic_load_n(&g_errcheck_node_self[node], __ATOMIC_RELAXED); }
+    static inline uint8_t  errcheck_node_parent(uint8_t node){ return errcheck_node_parent_[node]; }
+    static inline const char *errcheck_node_name(uint8_t node) { return errcheck_node_name_[node]; }
+
+    #define ERRCHECK_ROLLUP_(err_flag) errcheck_rollup_record_((uint32_t)(err_flag))
+#else
+    #define ERRCHECK_ROLLUP_(err_flag) ((void)0)
+#endif
+
+/* ========================================================================= */
+/* Optional: Propagation Chains                                              */
+/* ========================================================================= */
+/* Records every frame an error passes through on its way up: the CHECK that
+ * failed first, then each caller whose CHECK saw ERR_FAILURE. frames[0] is
+ * the origin. The chain belongs to the current thread (see ERRCHECK_TLS).
+ *
+ *     ERRCHECK_TLS errcheck_chain_t g_errcheck_chain;
+ *
+ * Whoever handles the failure calls errcheck_clear(); the next failure then
+ * starts a new chain.
+ */
+#ifdef ERRCHECK_ENABLE_CHAIN
+    #ifndef ERRCHECK_CHAIN_DEPTH
+        #define ERRCHECK_CHAIN_DEPTH 8
+    #endif
+
+    typedef struct {
+        uint32_t    site;
+        uint32_t    err;
+        const char *func;
+    } errcheck_frame_t;
+
+    typedef struct {
+        uint8_t          depth;       /* frames in use */
+        uint8_t          truncated;   /* frames that did not fit */
+        errcheck_frame_t frames[ERRCHECK_CHAIN_DEPTH];
+    } errcheck_chain_t;
+
+    extern ERRCHECK_TLS errcheck_chain_t g_errcheck_chain;
+
+    static inline void errcheck_chain_push_(uint32_t site, uint32_t err, const char *func)
+    {
+        errcheck_chain_t *c = &g_errcheck_chain;
+        if (c->depth < ERRCHECK_CHAIN_DEPTH) {
+            c->frames[c->depth].site = site;
+            c->frames[c->depth].err  = err;
+            c->frames[c->depth].func = func;
+            c->depth++;
+        } else if (c->truncated < 0xFF) {
+            c->truncated++;
+        }
+    }
+
+    #define ERRCHECK_CHAIN_(site, err_flag)                                \
+        errcheck_chain_push_((site), (uint32_t)(err_flag), __func__)
+    #define ERRCHECK_CLEAR_CHAIN_() (g_errcheck_chain.depth = 0, g_errcheck_chain.truncated = 0)
+#else
+    #define ERRCHECK_CHAIN_(site, err_flag) ((void)0)
+    #define ERRCHECK_CLEAR_CHAIN_()         ((void)0)
+#endif
+
+/* ========================================================================= */
+/* Optional: Failure Flamegraphs (folded propagation chains)                 */
+/* ========================================================================= */
+/* Every chain acknowledged with errcheck_clear() is aggregated by path; the
+ * exporter prints one folded stack per distinct path, outermost caller first
+ * and the error code as the leaf, weighted by how often it happened or by
+ * the time it wasted:
+ *
+ *     system_start;calibrate;read_reference;E1 42
+ *
+ *     errcheck_flame_slot_t g_errcheck_flame[ERRCHECK_FLAME_SLOTS];
+ *
+ *     errcheck_clear();                    // counts the path once
+ *     errcheck_clear_wasted(elapsed);      // also adds 'elapsed' (any unit)
+ *     errcheck_flame_dump(ERRCHECK_FLAME_BY_WASTED);   // via errcheck_putc
+ *
+ * Frame names are the __func__ of each failing CHECK. Pipe the output into
+ * flamegraph.pl. Requires ERRCHECK_ENABLE_CHAIN.
+ */
+#ifdef ERRCHECK_ENABLE_FLAME
+    #ifndef ERRCHECK_ENABLE_CHAIN
+        #error "ERRCHECK_ENABLE_FLAME requires ERRCHECK_ENABLE_CHAIN"
+    #endif
+    #ifndef ERRCHECK_FLAME_SLOTS
+        #define ERRCHECK_FLAME_SLOTS 32         /* power of two */
+    #endif
+
+    #define ERRCHECK_FLAME_BY_COUNT  0
+    #define ERRCHECK_FLAME_BY_WASTED 1
+
+    typedef struct {
+        uint32_t         state;                 /* errcheck_slot_claim_ */
+        uint32_t         hash;
+        errcheck_chain_t chain;
+        uint32_t         count;
+        uint32_t         wasted;
+    } errcheck_flame_slot_t;
+
+    extern errcheck_flame_slot_t g_errcheck_flame[ERRCHECK_FLAME_SLOTS];
+
+    static inline void errcheck_flame_commit_(const errcheck_chain_t *c, uint32_t wasted)
+    {
+        uint32_t h = 2166136261u, i, probe;
+        if (c->depth == 0) return;
+        for (i = 0; i < c->depth; i++) {
+            h = (h ^ (uint32_t)(uintptr_t)c->frames[i].func) * 16777619u;
+            h = (h ^ c->frames[i].site) * 16777619u;
+        }
+        h = (h ^ c->frames[0].err) * 16777619u;
+
+        for (probe = 0, i = h & (ERRCHECK_FLAME_SLOTS - 1); probe < ERRCHECK_FLAME_SLOTS;
+             probe++, i = (i + 1) & (ERRCHECK_FLAME_SLOTS - 1)) {
+            errcheck_flame_slot_t *s = &g_errcheck_flame[i];
+            uint32_t st = errcheck_slot_claim_(&s->state);
+
+            if (st == ERRCHECK_SLOT_OWNED_) {
+                s->hash  = h;
+                s->chain = *c;
+                errcheck_slot_publish_(&s->state);
+                st = ERRCHECK_SLOT_READY_;
+            }
+            if (st == ERRCHECK_SLOT_READY_ && s->hash == h && s->chain.depth == c->depth) {
+                __atomic_fetch_add(&s->count, 1, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&s->wasted, wasted, __ATOMIC_RELAXED);
+                return;
+            }
+        }
+        /* table full: path not recorded; raise ERRCHECK_FLAME_SLOTS */
+    }
+
+    static inline void errcheck_flame_dump(int weight)
+    {
+        uint32_t i;
+        int k;
+        for (i = 0; i < ERRCHECK_FLAME_SLOTS; i++) {
+            const errcheck_flame_slot_t *s = &g_errcheck_flame[i];
+            uint32_t v;
+            if (__atomic_load_n(&s->state, __ATOMIC_ACQUIRE) != ERRCHECK_SLOT_READY_) continue;
+            v = (weight == ERRCHECK_FLAME_BY_WASTED) ? s->wasted : s->count;
+            if (!v) continue;
+            for (k = s->chain.depth - 1; k >= 0; k--) {
+                /* a function that re-checks its own failure appears once */
+                if (k < s->chain.depth - 1 && s->chain.frames[k].func == s->chain.frames[k + 1].func) continue;
+                errcheck_put_str(s->chain.frames[k].func);
+                errcheck_putc(';');
+            }
+            errcheck_putc('E');
+            errcheck_put_u32(s->chain.frames[0].err);
+            errcheck_putc(' ');
+            errcheck_put_u32(v);
+            errcheck_putc('\n');
+        }
+    }
+
+    #define ERRCHECK_FLAME_COMMIT_(wasted) errcheck_flame_commit_(&g_errcheck_chain, (wasted))
+#else
+    #define ERRCHECK_FLAME_COMMIT_(wasted) ((void)0)
+#endif
+
+/* ========================================================================= */
+/* Optional: Swallowed-Error Detector                                        */
+/* ========================================================================= */
+/* The classic misuse of this pattern is a caller that ignores ERR_FAILURE
+ * and carries on half-initialized. With the detector on, every failure is
+ * "pending" until someone acknowledges it with errcheck_clear(); a CHECK
+ * that succeeds while a failure is still pending reports the leak:
+ *
+ *     void errcheck_swallowed(uint32_t failed_site, uint32_t err, uint32_t site)
+ *     {
+ *         printf("E%u:%u ignored, execution continued at %u\n", failed_site, err, site);
+ *     }
+ *
+ *     sensor_init();                      // fails, result dropped
+ *     CHECK(radio_init(), ERR_RADIO);     // first CHECK inside radio_init() reports
+ *
+ * Propagating a failure (a failing CHECK, RETURN_ERR) keeps it pending, so
+ * only the frame that drops it is blamed. The success-path cost is one
+ * thread-local flag test per CHECK; define the flag yourself:
+ *
+ *     ERRCHECK_TLS uint32_t g_errcheck_pending_site;
+ *
+ * Each leak is reported once. Mark prototypes ERRCHECK_NODISCARD to catch
+ * the same bug at compile time where the caller drops the result outright.
+ */
+#ifdef ERRCHECK_ENABLE_SWALLOW_DETECT
+    extern ERRCHECK_TLS uint32_t g_errcheck_pending_site;
+
+    #ifndef ERRCHECK_ON_SWALLOWED
+        extern void errcheck_swallowed(uint32_t failed_site, uint32_t err, uint32_t site);
+        #define ERRCHECK_ON_SWALLOWED(failed_site, err, site)              \
+            errcheck_swallowed((failed_site), (err), (site))
+    #endif
+
+    __attribute__((noinline, cold, unused))
+    static void errcheck_swallowed_(uint32_t site)
+    {
+        uint32_t failed = g_errcheck_pending_site;
+        g_errcheck_pending_site = 0;
+        ERRCHECK_ON_SWALLOWED(failed, (uint32_t)g_last_error, site);
+    }
+
+    /* Site ids are never 0, so 0 means "nothing pending" */
+    #define ERRCHECK_PENDING_(site)     (g_errcheck_pending_site = (site))
+    #define ERRCHECK_ON_SUCCESS_(site)                                     \
+        (__builtin_expect(g_errcheck_pending_site != 0, 0) ? errcheck_swallowed_(site) : (void)0)
+    #define ERRCHECK_SWALLOW_ACK_()     (g_errcheck_pending_site = 0)
+#else
+    #define ERRCHECK_PENDING_(site)     ((void)0)
+    #define ERRCHECK_ON_SUCCESS_(site)  ((void)0)
+    #define ERRCHECK_SWALLOW_ACK_()     ((void)0)
+#endif
+
+/* Result must be used: warn_unused_result / [[nodiscard]] where available */
+#ifndef ERRCHECK_NODISCARD
+    #if defined(__cplusplus) && __cplusplus >= 201703L
+        #define ERRCHECK_NODISCARD [[nodiscard]]
+    #elif defined(__GNUC__)
+        #define ERRCHECK_NODISCARD __attribute__((warn_unused_result))
+    #else
+        #define ERRCHECK_NODISCARD
+    #endif
+#endif
+
+/* Futures hand the site of the first failure since the last errcheck_clear()
+   to the waiting thread; it is tracked per thread, chain or not */
+#ifdef ERRCHECK_ENABLE_FUTURES
+    extern ERRCHECK_TLS uint32_t g_errcheck_origin_site;
+    extern uint32_t              g_errcheck_future_bell;
+
+    #define ERRCHECK_ORIGIN_(site)                                         \
+        (g_errcheck_origin_site ? (void)0 : (void)(g_errcheck_origin_site = (site)))
+    #define ERRCHECK_CLEAR_ORIGIN_()    (g_errcheck_origin_site = 0)
+#else
+    #define ERRCHECK_ORIGIN_(site)      ((void)0)
+    #define ERRCHECK_CLEAR_ORIGIN_()    ((void)0)
+#endif
+
+/* Acknowledge the current failure (it has been handled) */
+static inline void errcheck_clear(void)
+{
+    ERRCHECK_FLAME_COMMIT_(0);
+    ERRCHECK_CLEAR_CHAIN_();
+    ERRCHECK_CLEAR_ORIGIN_();
+    ERRCHECK_SWALLOW_ACK_();
+}
+
+/* Same, recording how much time the failed attempt wasted (flamegraphs) */
+static inline void errcheck_clear_wasted(uint32_t wasted)
+{
+    ERRCHECK_FLAME_COMMIT_(wasted);
+    ERRCHECK_CLEAR_CHAIN_();
+    ERRCHECK_CLEAR_ORIGIN_();
+    ERRCHECK_SWALLOW_ACK_();
+    (void)wasted;
+}
+
+/* ========================================================================= */
+/* Optional: Non-Local Fail-Fast (setjmp/longjmp)                            */
+/* ========================================================================= */
+/* In deep parser/protocol stacks every layer re-checks its callee, which is
+ * a compare and branch per frame on the success path. In non-local mode a
+ * failing CHECK beneath a landing pad jumps straight to the pad, so the
+ * layers in between need no checks at all:
+ *
+ *     err_t parse_message(const uint8_t *buf)
+ *     {
+ *         ERRCHECK_LANDING_PAD(pad) {
+ *             return ERR_FAILURE;            // g_last_error, pad.site, pad.err set
+ *         }
+ *         parse_header(buf);                 // void layers, no per-frame checks
+ *         parse_body(buf);                   // ... CHECK_VOID(crc_ok(b), ERR_CRC) deep inside
+ *         return ERR_NONE;
+ *     }
+ *
+ *     ERRCHECK_TLS errcheck_pad_t     *g_errcheck_pad;
+ *     ERRCHECK_TLS errcheck_cleanup_t *g_errcheck_cleanup;
+ *
+ * Frames that hold resources register them with ERRCHECK_DEFER(fn, arg): fn
+ * runs when the frame returns normally, or — newest first — before the jump
+ * when a failure skips the frame. ERRCHECK_SCOPE tags are restored at the
+ * pad as well. Failure hooks run at the failing CHECK, as in local mode;
+ * with no pad active a CHECK returns as usual. Locals of the pad's function
+ * that change after the pad is set must be volatile to be read in the handler.
+ */
+#ifdef ERRCHECK_ENABLE_NONLOCAL
+    #include <setjmp.h>
+
+    typedef struct errcheck_cleanup {
+        void                   (*fn)(void *arg);
+        void                    *arg;
+        struct errcheck_cleanup *prev;
+    } errcheck_cleanup_t;
+
+    typedef struct errcheck_pad {
+        jmp_buf              env;
+        struct errcheck_pad *prev;
+        errcheck_cleanup_t  *cleanup;      /* cleanup stack when the pad was set */
+        uint32_t             scope_mask;
+        uint32_t             site;         /* where the failure came from */
+        uint32_t             err;
+    } errcheck_pad_t;
+
+    extern ERRCHECK_TLS errcheck_pad_t     *g_errcheck_pad;
+    extern ERRCHECK_TLS errcheck_cleanup_t *g_errcheck_cleanup;
+
+    static inline void errcheck_pad_enter_(errcheck_pad_t *p)
+    {
+        p->prev       = g_errcheck_pad;
+        p->cleanup    = g_errcheck_cleanup;
+    #ifdef ERRCHECK_ENABLE_INJECTION_PLAN
+        p->scope_mask = g_errcheck_scope_mask;
+    #endif
+        g_errcheck_pad = p;
+    }
+
+    /* Normal exit from the pad's function (already popped if it landed) */
+    static inline void errcheck_pad_leave_(errcheck_pad_t *p)
+    {
+        if (g_errcheck_pad == p) g_errcheck_pad = p->prev;
+    }
+
+    __attribute__((noinline, cold, noreturn, unused))
+    static void errcheck_nonlocal_fail_(uint32_t site, uint32_t err)
+    {
+        errcheck_pad_t *p = g_errcheck_pad;
+        while (g_errcheck_cleanup != p->cleanup) {
+            errcheck_cleanup_t *c = g_errcheck_cleanup;
+            g_errcheck_cleanup = c->prev;
+            c->fn(c->arg);
+        }
+    #ifdef ERRCHECK_ENABLE_INJECTION_PLAN
+        g_errcheck_scope_mask = p->scope_mask;   /* skipped frames' ERRCHECK_SCOPEs */
+    #endif
+        p->site = site;
+        p->err  = err;
+        g_errcheck_pad = p->prev;
+        longjmp(p->env, 1);
+    }
+
+    static inline void errcheck_defer_exit_(errcheck_cleanup_t *c)
+    {
+        if (g_errcheck_cleanup == c) {             /* not already run by a jump */
+            g_errcheck_cleanup = c->prev;
+            c->fn(c->arg);
+        }
+    }
+
+    #define ERRCHECK_LANDING_PAD(pad)                                      \
+        errcheck_pad_t pad __attribute__((cleanup(errcheck_pad_leave_)));  \
+        errcheck_pad_enter_(&pad);                                         \
+        if (setjmp(pad.env) != 0)
+
+    #define ERRCHECK_DEFER(fn, arg)                                        \
+        ERRCHECK_DEFER_AS_(ERRCHECK_DEFER_NAME_(__COUNTER__), fn, arg)
+    #define ERRCHECK_DEFER_NAME_(n)  ERRCHECK_DEFER_NAME2_(n)
+    #define ERRCHECK_DEFER_NAME2_(n) errcheck_defer_##n##_
+    #define ERRCHECK_DEFER_AS_(name, fn, arg)                              \
+        errcheck_cleanup_t name __attribute__((cleanup(errcheck_defer_exit_))) = \
+            { (fn), (arg), g_errcheck_cleanup };                           \
+        g_errcheck_cleanup = &name
+
+    /* A failing CHECK leaves through the pad when one is set */
+    #define ERRCHECK_UNWIND_(site, err_flag)                               \
+        (g_errcheck_pad ? errcheck_nonlocal_fail_((site), (uint32_t)(err_flag)) : (void)0)
+#endif
+
+/* ========================================================================= */
+/* Optional: C++ Exception Bridge                                            */
+/* ========================================================================= */
+/* With table-based (zero-cost) exceptions the success path of throw-based
+ * propagation has no compare and branch at all. In this mode every failing
+ * CHECK throws a small trivially-copyable errcheck_error { err, site,
+ * payload } after its failure hooks have run; C-callable entry points
+ * convert it back at the boundary:
+ *
+ *     extern "C" err_t device_init(void)
+ *     {
+ *         ERRCHECK_BOUNDARY_BEGIN
+ *             power.init();                  // no checks between layers
+ *             radio.init();                  // CHECK deep inside throws
+ *             return ERR_NONE;
+ *         ERRCHECK_BOUNDARY_END(ERR_FAILURE) // g_last_error = e.err
+ *     }
+ *
+ * 'payload' is ERRCHECK_ERROR_PAYLOAD() at the failing site (0 unless you
+ * define it, e.g. as errno or a context pointer). The throw is outlined and
+ * cold, so a CHECK's failure path stays one call. An errcheck_error that
+ * escapes every boundary calls std::terminate, as any uncaught exception.
+ */
+#ifdef ERRCHECK_ENABLE_EXCEPTIONS
+    #if !defined(__cplusplus) || !(defined(__cpp_exceptions) || defined(__EXCEPTIONS))
+        #error "ERRCHECK_ENABLE_EXCEPTIONS needs C++ with exceptions enabled"
+    #endif
+    #ifdef ERRCHECK_ENABLE_NONLOCAL
+        #error "ERRCHECK_ENABLE_EXCEPTIONS and ERRCHECK_ENABLE_NONLOCAL are exclusive"
+    #endif
+
+    #ifndef ERRCHECK_ERROR_PAYLOAD
+        #define ERRCHECK_ERROR_PAYLOAD() 0
+    #endif
+
+    struct errcheck_error {
+        uint32_t  err;
+        uint32_t  site;
+        uintptr_t payload;
+    };
+
+    __attribute__((noinline, cold, noreturn, unused))
+    static void errcheck_throw_(uint32_t site, uint32_t err, uintptr_t payload)
+    {
+        errcheck_error e = { err, site, payload };
+        throw e;
+    }
+
+    #define ERRCHECK_UNWIND_(site, err_flag)                               \
+        errcheck_throw_((site), (uint32_t)(err_flag), (uintptr_t)(ERRCHECK_ERROR_PAYLOAD()))
+
+    #define ERRCHECK_BOUNDARY_BEGIN try {
+    #define ERRCHECK_BOUNDARY_END(retval)                                  \
+        } catch (const errcheck_error &errcheck_e_) {                      \
+            g_last_error = (err_t)errcheck_e_.err;                         \
+            return retval;                                                 \
+        }
+#endif
+
+#ifndef ERRCHECK_UNWIND_
+    #define ERRCHECK_UNWIND_(site, err_flag) ((void)0)
+#endif
+
+/* ========================================================================= */
+/* Optional: Error-Carrying Futures (cross-thread fail-fast)                 */
+/* ========================================================================= */
+/* A worker completes the future with the err_t its function returned; on
+ * ERR_FAILURE the worker's g_last_error, failing site and chain are copied
+ * into the future. The submitting thread waits with CHECK_FUTURE, which
+ * re-raises the failure exactly like a failed CHECK in its own frame.
+ *
+ *     errcheck_future_t f;                 // caller-owned: no allocation
+ *     errcheck_future_init(&f);
+ *     pool_submit(worker, &f);             // worker: errcheck_future_complete(&f, job());
+ *     CHECK_FUTURE(&f);                    // returns ERR_FAILURE if the job failed
+ *
+ * The failing site travels in g_errcheck_origin_site, which CHECK_FUTURE
+ * adopts, so the origin survives any number of hand-overs; define it per
+ * thread next to g_last_error:
+ *
+ *     ERRCHECK_TLS uint32_t g_errcheck_origin_site;
+ *
+ * Waiting uses a futex on Linux (a wake syscall only when someone sleeps).
+ * Sleepers wait on one wake word shared by all futures, never on the future
+ * itself: the waiter may return and release the future's memory as soon as
+ * the result is published, so the worker touches nothing of it afterwards.
+ * A completion wakes every sleeper, and each re-checks its own future:
+ *
+ *     uint32_t g_errcheck_future_bell;
+ *
+ * Elsewhere define ERRCHECK_FUTURE_WAIT(addr, val) / ERRCHECK_FUTURE_WAKE(addr)
+ * for your RTOS ('addr' is always &g_errcheck_future_bell); the default is a
+ * spin. Use ERRCHECK_TLS for g_last_error.
+ */
+#ifdef ERRCHECK_ENABLE_FUTURES
+    #if !defined(ERRCHECK_FUTURE_WAIT) && defined(__linux__)
+        #include <unistd.h>
+        #include <sys/syscall.h>
+        #include <linux/futex.h>
+        #define ERRCHECK_FUTURE_WAIT(addr, val)                            \
+            syscall(SYS_futex, (addr), FUTEX_WAIT_PRIVATE, (val), NULL, NULL, 0)
+        #define ERRCHECK_FUTURE_WAKE(addr)                                 \
+            syscall(SYS_futex, (addr), FUTEX_WAKE_PRIVATE, 0x7FFFFFFF, NULL, NULL, 0)
+    #elif !defined(ERRCHECK_FUTURE_WAIT)
+        #define ERRCHECK_FUTURE_WAIT(addr, val) ((void)0)
+        #define ERRCHECK_FUTURE_WAKE(addr)      ((void)0)
+    #endif
+
+    #define ERRCHECK_FUTURE_PENDING_  0u
+    #define ERRCHECK_FUTURE_OK_       1u
+    #define ERRCHECK_FUTURE_FAILED_   2u
+    #define ERRCHECK_FUTURE_WAITING_  3u   /* pending, and a waiter sleeps */
+
+    typedef struct {
+        uint32_t         state;   /* futex word */
+        err_t            code;
+        uint32_t         site;
+    #ifdef ERRCHECK_ENABLE_CHAIN
+        errcheck_chain_t chain;
+    #endif
+    } errcheck_future_t;
+
+    static inline void errcheck_future_init(errcheck_future_t *f)
+    {
+        __atomic_store_n(&f->state, ERRCHECK_FUTURE_PENDING_, __ATOMIC_RELAXED);
+    }
+
+    /* Worker side: publish the job's result (and its failure context) */
+    static inline void errcheck_future_complete(errcheck_future_t *f, err_t result)
+    {
+        uint32_t done = ERRCHECK_FUTURE_OK_;
+        if (result == ERR_FAILURE) {
+            f->code = g_last_error;
+            f->site = g_errcheck_origin_site;
+    #ifdef ERRCHECK_ENABLE_CHAIN
+            f->chain = g_errcheck_chain;
+    #endif
+            ERRCHECK_CLEAR_CHAIN_();   /* handed over to the waiter */
+            ERRCHECK_CLEAR_ORIGIN_();
+            ERRCHECK_SWALLOW_ACK_();
+            done = ERRCHECK_FUTURE_FAILED_;
+        }
+        /* 'f' may be gone once the exchange lands: ring the shared bell only */
+        if (__atomic_exchange_n(&f->state, done, __ATOMIC_ACQ_REL) == ERRCHECK_FUTURE_WAITING_) {
+            __atomic_fetch_add(&g_errcheck_future_bell, 1, __ATOMIC_RELEASE);
+            ERRCHECK_FUTURE_WAKE(&g_errcheck_future_bell);
+        }
+    }
+
+    /* Waiter side: blocks until completion, returns nonzero on success */
+    static inline int errcheck_future_wait(errcheck_future_t *f)
+    {
+        for (;;) {
+            /* The bell is read before the state: a completion this read
+               missed rings it later, so the wait below cannot sleep through it */
+            uint32_t bell = __atomic_load_n(&g_errcheck_future_bell, __ATOMIC_ACQUIRE);
+            uint32_t s    = __atomic_load_n(&f->state, __ATOMIC_ACQUIRE);
+            if (s == ERRCHECK_FUTURE_OK_ || s == ERRCHECK_FUTURE_FAILED_) return s == ERRCHECK_FUTURE_OK_;
+            if (s == ERRCHECK_FUTURE_WAITING_ ||
+                __atomic_compare_exchange_n(&f->state, &s, ERRCHECK_FUTURE_WAITING_, 0,
+                                            __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+                ERRCHECK_FUTURE_WAIT(&g_errcheck_future_bell, bell);
+        }
+    }
+
+    /* Moves the worker's failure context into this thread before re-raising */
+    static inline void errcheck_future_adopt_(const errcheck_future_t *f)
+    {
+        g_last_error = f->code;
+        if (f->site) g_errcheck_origin_site = f->site;
+    #ifdef ERRCHECK_ENABLE_CHAIN
+        g_errcheck_chain = f->chain;
+    #endif
+    }
+
+    #define CHECK_FUTURE_RET(fut, retval) ERRCHECK_CHECK_FUTURE_((fut), retval, #fut)
+    #define CHECK_FUTURE(fut) ERRCHECK_CHECK_FUTURE_((fut), ERR_FAILURE, #fut)
+
+    #define ERRCHECK_CHECK_FUTURE_(fut, retval, fut_s) do {                \
+        if (!errcheck_future_wait(fut)) {                                  \
+            const uint32_t errcheck_site_ = ERRCHECK_SITE_ID(fut_s, "");   \
+            errcheck_future_adopt_(fut);                                   \
+            ERRCHECK_PLAN_FAILED_(errcheck_site_, (fut)->code);            \
+            ERRCHECK_ON_FAILURE_(errcheck_site_, (fut)->code);             \
+            ERRCHECK_UNWIND_(errcheck_site_, (fut)->code);                 \
+            return retval;                                                 \
+        }                                                                  \
+    } while (0)
+#endif
+
+/* ========================================================================= */
+/* Optional: Interrupt-to-Task Error Queue (SPSC, wait-free)                 */
+/* ========================================================================= */
+/* Failures detected in interrupt context (or a signal handler in the Linux
+ * simulation) are pushed as compact records and drained by the main loop.
+ * One producer context, one consumer context; neither ever blocks or loops.
+ *
+ *     errcheck_queue_t g_errcheck_isr_queue;
+ *
+ *     void ADC_IRQHandler(void)
+ *     {
+ *         CHECK_ISR(adc_result_valid(), ERR_ADC);    // push + return on failure
+ *     }
+ *
+ *     main loop:  errcheck_queue_drain(&g_errcheck_isr_queue);  // → sinks
+ *
+ * A full queue counts the record in 'dropped' instead of waiting. Head and
+ * tail sit on separate cache lines (ERRCHECK_CACHE_LINE) so producer and
+ * consumer never share a line.
+ */
+#ifdef ERRCHECK_ENABLE_ISR_QUEUE
+    #ifndef ERRCHECK_QUEUE_CAPACITY
+        #define ERRCHECK_QUEUE_CAPACITY 32      /* power of two */
+    #endif
+    #ifndef ERRCHECK_CACHE_LINE
+        #define ERRCHECK_CACHE_LINE     64
+    #endif
+
+    typedef char errcheck_queue_capacity_is_power_of_two_
+        [(ERRCHECK_QUEUE_CAPACITY & (ERRCHECK_QUEUE_CAPACITY - 1)) == 0 ? 1 : -1];
+
+    typedef struct {
+        uint32_t site;
+        uint32_t err;
+    } errcheck_record_t;
+
+    typedef struct {
+        /* producer-owned line */
+        uint32_t head __attribute__((aligned(ERRCHECK_CACHE_LINE)));
+        uint32_t dropped;
+        /* consumer-owned line */
+        uint32_t tail __attribute__((aligned(ERRCHECK_CACHE_LINE)));
+        errcheck_record_t buf[ERRCHECK_QUEUE_CAPACITY] __attribute__((aligned(ERRCHECK_CACHE_LINE)));
+    } errcheck_queue_t;
+
+    extern errcheck_queue_t g_errcheck_isr_queue;
+
+    /* Producer: wait-free, returns 0 (and counts a drop) when full */
+    static inline int errcheck_queue_push(errcheck_queue_t *q, uint32_t site, uint32_t err)
+    {
+        uint32_t h = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+        uint32_t t = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+        errcheck_record_t *r;
+
+        if ((uint32_t)(h - t) == ERRCHECK_QUEUE_CAPACITY) {
+            __atomic_store_n(&q->dropped, q->dropped + 1, __ATOMIC_RELAXED);
+            return 0;
+        }
+        r = &q->buf[h & (ERRCHECK_QUEUE_CAPACITY - 1)];
+        r->site = site;
+        r->err  = err;
+        __atomic_store_n(&q->head, h + 1, __ATOMIC_RELEASE);
+        return 1;
+    }
+
+    /* Consumer: copies up to 'max' records in one batch, returns the count */
+    static inline uint32_t errcheck_queue_pop(errcheck_queue_t *q, errcheck_record_t *out, uint32_t max)
+    {
+        uint32_t t = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+        uint32_t h = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+        uint32_t n = h - t, i;
+
+        if (n > max) n = max;
+        for (i = 0; i < n; i++) out[i] = q->buf[(t + i) & (ERRCHECK_QUEUE_CAPACITY - 1)];
+        __atomic_store_n(&q->tail, t + n, __ATOMIC_RELEASE);
+        return n;
+    }
+
+    /* Consumer: forwards everything queued to the enabled sinks */
+    static inline uint32_t errcheck_queue_drain(errcheck_queue_t *q)
+    {
+        errcheck_record_t batch[8];
+        uint32_t n, i, total = 0;
+        while ((n = errcheck_queue_pop(q, batch, 8)) != 0) {
+            for (i = 0; i < n; i++) errcheck_emit_(batch[i].site, batch[i].err, 1);
+            total += n;
+        }
+        return total;
+    }
+
+    /* ISR forms: no g_last_error write, no sink call — just a queued record */
+    #define CHECK_ISR_RET(call, err_flag, retval)                          \
+        ERRCHECK_CHECK_ISR_((call), (err_flag), retval, #call, #err_flag)
+    #define CHECK_ISR(call, err_flag)                                      \
+        ERRCHECK_CHECK_ISR_((call), (err_flag), , #call, #err_flag)
+
+    #define ERRCHECK_CHECK_ISR_(call, err_flag, retval, call_s, err_s) do { \
+        if (ERRCHECK_FAILED_OR_INJECTED_((call) == 0,                      \
+                ERRCHECK_SITE_ID(call_s, err_s), err_flag)) {              \
+            const uint32_t errcheck_site_ = ERRCHECK_SITE_ID(call_s, err_s); \
+            ERRCHECK_INJECT_CLEAR_();                                      \
+            (void)errcheck_queue_push(&g_errcheck_isr_queue,               \
+                                      errcheck_site_, (uint32_t)(err_flag)); \
+            return retval;                                                 \
+        }                                                                  \
+    } while (0)
+
+    #define RETURN_ERR_ISR(err_flag) do {                                  \
+        (void)errcheck_queue_push(&g_errcheck_isr_queue,                   \
+            ERRCHECK_SITE_ID("", #err_flag), (uint32_t)(err_flag));        \
+        return;                                                            \
+    } while (0)
+#endif
+
+/* ========================================================================= */
+/* Optional: Observer Hooks (telemetry, DTC store, tracing)                  */
+/* ========================================================================= */
+/* Observers are attached to an error code (optionally narrowed to one site)
+ * or to every code with ERRCHECK_HOOK_ANY. errcheck_hooks_publish() compiles
+ * them into a dense, immutable table: each code owns one contiguous run of
+ * function pointers, so a failure calls exactly the observers of its code —
+ * no lock, no search. ERRCHECK_HOOK_ANY observers (including site-only ones)
+ * share one more run, called after the code's own.
+ *
+ *     errcheck_hooks_t g_errcheck_hooks;
+ *
+ *     errcheck_hooks_add(ERR_RADIO, 0, dtc_store);        // all ERR_RADIO sites
+ *     errcheck_hooks_add(ERRCHECK_HOOK_ANY, 0, telemetry_count);
+ *     errcheck_hooks_publish();
+ *
+ * Publishing again later (RCU-style) builds the other table, swaps the
+ * active pointer and waits until no failure path still reads the old one;
+ * failures that start meanwhile use the new table and never delay it.
+ * Add/publish from one thread, not from an ISR, and never from inside an
+ * observer (publish would wait for that observer to return). Codes >=
+ * ERRCHECK_HOOK_CODES share one overflow bucket.
+ */
+#ifdef ERRCHECK_ENABLE_HOOKS
+    #ifndef ERRCHECK_HOOK_CODES
+        #define ERRCHECK_HOOK_CODES 32      /* codes dispatched densely */
+    #endif
+    #ifndef ERRCHECK_HOOK_MAX
+        #define ERRCHECK_HOOK_MAX   16      /* registered observers */
+    #endif
+
+    #define ERRCHECK_HOOK_ANY 0xFFFFFFFFu
+    #define ERRCHECK_HOOK_BUCKETS_ (ERRCHECK_HOOK_CODES + 1)   /* + overflow */
+    #define ERRCHECK_HOOK_ANY_RUN_ ERRCHECK_HOOK_BUCKETS_       /* ANY observers */
+
+    typedef void (*errcheck_hook_fn)(uint32_t site, uint32_t err);
+
+    typedef struct {
+        errcheck_hook_fn fn;
+        uint32_t         site;      /* 0 = every site */
+    } errcheck_hook_entry_t;
+
+    typedef struct {
+        uint16_t              first[ERRCHECK_HOOK_BUCKETS_ + 2];
+        errcheck_hook_entry_t entry[ERRCHECK_HOOK_MAX];     /* each observer once */
+    } errcheck_hook_table_t;
+
+    typedef struct {
+        /* read by the failure path */
+        const errcheck_hook_table_t *active;
+        uint32_t                     readers[2];   /* failure paths inside table[i] */
+        /* owned by the registering thread */
+        errcheck_hook_table_t        table[2];
+        uint32_t                     code[ERRCHECK_HOOK_MAX];
+        errcheck_hook_entry_t        pending[ERRCHECK_HOOK_MAX];
+        uint8_t                      count;
+    } errcheck_hooks_t;
+
+    extern errcheck_hooks_t g_errcheck_hooks;
+
+    static inline uint32_t errcheck_hook_bucket_(uint32_t err)
+    {
+        return err < ERRCHECK_HOOK_CODES ? err : ERRCHECK_HOOK_CODES;
+    }
+
+    /* Stages an observer; returns 0 when ERRCHECK_HOOK_MAX is reached */
+    static inline int errcheck_hooks_add(uint32_t err, uint32_t site, errcheck_hook_fn fn)
+    {
+        errcheck_hooks_t *h = &g_errcheck_hooks;
+        if (h->count == ERRCHECK_HOOK_MAX) return 0;
+        h->code[h->count]         = err;
+        h->pending[h->count].fn   = fn;
+        h->pending[h->count].site = site;
+        h->count++;
+        return 1;
+    }
+
+    /* Builds the inactive table and swaps it in; returns 1. Every staged
+       observer occupies exactly one entry, so the table always fits. */
+    static inline int errcheck_hooks_publish(void)
+    {
+        errcheck_hooks_t *h = &g_errcheck_hooks;
+        errcheck_hook_table_t *t = (h->active == &h->table[0]) ? &h->table[1] : &h->table[0];
+        uint32_t b, i, n = 0;
+
+        for (b = 0; b <= ERRCHECK_HOOK_ANY_RUN_; b++) {
+            t->first[b] = (uint16_t)n;
+            for (i = 0; i < h->count; i++) {
+                uint32_t run = h->code[i] == ERRCHECK_HOOK_ANY ? ERRCHECK_HOOK_ANY_RUN_
+                                                               : errcheck_hook_bucket_(h->code[i]);
+                if (run == b) t->entry[n++] = h->pending[i];
+            }
+        }
+        t->first[ERRCHECK_HOOK_ANY_RUN_ + 1] = (uint16_t)n;
+
+        /* Grace period: the previous table may be rebuilt once nobody reads
+           it. Store 'active' / load 'readers' here against increment
+           'readers' / load 'active' in dispatch is store-buffering: both
+           sides must be seq_cst, or each could miss the other's store. */
+        __atomic_store_n(&h->active, t, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n(&h->readers[t == &h->table[0]], __ATOMIC_SEQ_CST) != 0) { }
+        return 1;
+    }
+
+    static inline void errcheck_hooks_run_(const errcheck_hook_table_t *t, uint32_t run,
+                                           uint32_t site, uint32_t err)
+    {
+        uint32_t i;
+        for (i = t->first[run]; i < t->first[run + 1]; i++) {
+            if (t->entry[i].site == 0 || t->entry[i].site == site)
+                t->entry[i].fn(site, err);
+        }
+    }
+
+    /* Counts itself in the table it reads; if that table was swapped out in
+       between, it backs off and reads the new one instead */
+    static inline void errcheck_hooks_dispatch_(uint32_t site, uint32_t err)
+    {
+        errcheck_hooks_t *h = &g_errcheck_hooks;
+        const errcheck_hook_table_t *t;
+        uint32_t i;
+
+        for (;;) {
+            t = __atomic_load_n(&h->active, __ATOMIC_SEQ_CST);
+            if (!t) return;
+            i = t != &h->table[0];
+            __atomic_fetch_add(&h->readers[i], 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&h->active, __ATOMIC_SEQ_CST) == t) break;
+            __atomic_fetch_sub(&h->readers[i], 1, __ATOMIC_RELEASE);
+        }
+        errcheck_hooks_run_(t, errcheck_hook_bucket_(err), site, err);
+        errcheck_hooks_run_(t, ERRCHECK_HOOK_ANY_RUN_, site, err);
+        __atomic_fetch_sub(&h->readers[i], 1, __ATOMIC_RELEASE);
+    }
+
+    #define ERRCHECK_HOOKS_(site, err_flag)                                \
+        errcheck_hooks_dispatch_((site), (uint32_t)(err_flag))
+#else
+    #define ERRCHECK_HOOKS_(site, err_flag) ((void)0)
+#endif
+
+/* ========================================================================= */
+/* Optional: Sampling Profiler                                               */
+/* ========================================================================= */
+/* Times 1 in ERRCHECK_SAMPLE_PERIOD checked calls (per thread) and captures
+ * the stack they were called from. An unsampled CHECK pays one decrement and
+ * one branch; the sampled one reads the tick counter twice and records into a
+ * fixed table keyed by (site, stack).
+ *
+ *     ERRCHECK_TLS uint32_t      g_errcheck_sample_countdown;
+ *     errcheck_profile_slot_t    g_errcheck_profile[ERRCHECK_PROFILE_SLOTS];
+ *     uint32_t errcheck_ticks(void) { return DWT->CYCCNT; }  // or ERRCHECK_TICKS()
+ *
+ * errcheck_profile_dump(weight) writes folded stacks through errcheck_putc,
+ * extrapolated by the sampling period — one line per (stack, site):
+ *
+ *     0x4011a3;0x401262;device_init;L57 1200
+ *
+ * weight: ERRCHECK_WEIGHT_CALLS, ERRCHECK_WEIGHT_FAILS or ERRCHECK_WEIGHT_TICKS.
+ * Frames come from backtrace() with glibc, otherwise the return address only;
+ * symbolise them with addr2line before feeding flamegraph.pl.
+ */
+#ifdef ERRCHECK_ENABLE_PROFILE
+    #ifndef ERRCHECK_SAMPLE_PERIOD
+        #define ERRCHECK_SAMPLE_PERIOD 1000
+    #endif
+    #ifndef ERRCHECK_PROFILE_SLOTS
+        #define ERRCHECK_PROFILE_SLOTS 64       /* power of two */
+    #endif
+    #ifndef ERRCHECK_PROFILE_DEPTH
+        #define ERRCHECK_PROFILE_DEPTH 8
+    #endif
+    #ifndef ERRCHECK_TICKS
+        extern uint32_t errcheck_ticks(void);
+        #define ERRCHECK_TICKS() errcheck_ticks()
+    #endif
+
+    #if !defined(ERRCHECK_CAPTURE_STACK) && defined(__GLIBC__)
+        #include <execinfo.h>
+        #define ERRCHECK_CAPTURE_STACK(frames, max) backtrace((frames), (max))
+    #elif !defined(ERRCHECK_CAPTURE_STACK)
+        #define ERRCHECK_CAPTURE_STACK(frames, max)                        \
+            ((frames)[0] = __builtin_return_address(0), 1)
+    #endif
+
+    #define ERRCHECK_WEIGHT_CALLS 0
+    #define ERRCHECK_WEIGHT_FAILS 1
+    #define ERRCHECK_WEIGHT_TICKS 2
+
+    typedef struct {
+        uint32_t    state;                       /* errcheck_slot_claim_ */
+        uint32_t    site;
+        uint32_t    hash;                        /* of the captured frames */
+        const char *func;
+        uint8_t     depth;
+        void       *frames[ERRCHECK_PROFILE_DEPTH];
+        uint32_t    samples;
+        uint32_t    fails;
+        uint64_t    ticks;                       /* a 32-bit sum wraps within minutes */
+    } errcheck_profile_slot_t;
+
+    extern ERRCHECK_TLS uint32_t    g_errcheck_sample_countdown;
+    extern errcheck_profile_slot_t  g_errcheck_profile[ERRCHECK_PROFILE_SLOTS];
+
+    /* Fast path: returns 0 unless this call is sampled */
+    static inline uint32_t errcheck_profile_begin_(void)
+    {
+        if (__builtin_expect(g_errcheck_sample_countdown-- != 0, 1)) return 0;
+        g_errcheck_sample_countdown = ERRCHECK_SAMPLE_PERIOD - 1;
+        return ERRCHECK_TICKS() | 1u;
+    }
+
+    __attribute__((noinline, cold, unused))
+    static void errcheck_profile_record_(uint32_t t0, uint32_t site, const char *func, int ok)
+    {
+        uint32_t dt = (ERRCHECK_TICKS() | 1u) - t0;
+        void *frames[ERRCHECK_PROFILE_DEPTH + 2];
+        int n = ERRCHECK_CAPTURE_STACK(frames, ERRCHECK_PROFILE_DEPTH + 2);
+        int skip = (n > 2) ? 2 : 0;             /* this function + the CHECK's own frame */
+        uint32_t h = site * 0x9E3779B1u, i, probe;
+
+        n -= skip;
+        for (i = 0; i < (uint32_t)n; i++) h = (h ^ (uint32_t)(uintptr_t)frames[skip + i]) * 16777619u;
+
+        for (probe = 0, i = h & (ERRCHECK_PROFILE_SLOTS - 1); probe < ERRCHECK_PROFILE_SLOTS;
+             probe++, i = (i + 1) & (ERRCHECK_PROFILE_SLOTS - 1)) {
+            errcheck_profile_slot_t *s = &g_errcheck_profile[i];
+            uint32_t st = errcheck_slot_claim_(&s->state);
+
+            if (st == ERRCHECK_SLOT_OWNED_) {
+                int k;
+                s->site = site; s->hash = h; s->func = func; s->depth = (uint8_t)n;
+                for (k = 0; k < n; k++) s->frames[k] = frames[skip + k];
+                errcheck_slot_publish_(&s->state);
+                st = ERRCHECK_SLOT_READY_;
+            }
+            if (st == ERRCHECK_SLOT_READY_ && s->site == site && s->hash == h) {
+                __atomic_fetch_add(&s->samples, 1, __ATOMIC_RELAXED);
+                __atomic_fetch_add(&s->ticks, dt, __ATOMIC_RELAXED);
+                if (!ok) __atomic_fetch_add(&s->fails, 1, __ATOMIC_RELAXED);
+                return;
+            }
+        }
+        /* table full: sample is lost; raise ERRCHECK_PROFILE_SLOTS */
+    }
+
+    /* Folded stacks (root first), values extrapolated by the sampling period */
+    static inline void errcheck_profile_dump(int weight)
+    {
+        uint32_t i;
+        int k;
+        for (i = 0; i < ERRCHECK_PROFILE_SLOTS; i++) {
+            const errcheck_profile_slot_t *s = &g_errcheck_profile[i];
+            uint64_t v;
+            if (__atomic_load_n(&s->state, __ATOMIC_ACQUIRE) != ERRCHECK_SLOT_READY_) continue;
+            v = weight == ERRCHECK_WEIGHT_TICKS ? __atomic_load_n(&s->ticks, __ATOMIC_RELAXED)
+              : weight == ERRCHECK_WEIGHT_FAILS ? s->fails : s->samples;
+            if (!v) continue;
+            for (k = s->depth - 1; k >= 0; k--) {
+                errcheck_put_hex_((uintptr_t)s->frames[k]);
+                errcheck_putc(';');
+            }
+            errcheck_put_str(s->func);
+            errcheck_put_str(";L");
+            errcheck_put_u32(s->site);
+            errcheck_putc(' ');
+            errcheck_put_u64(v * (uint64_t)ERRCHECK_SAMPLE_PERIOD);
+            errcheck_putc('\n');
+        }
+    }
+
+    /* The site id is only computed for sampled calls */
+    #define ERRCHECK_PROFILE_BEGIN_()                                      \
+        uint32_t errcheck_t0_ = errcheck_profile_begin_(); int errcheck_ok_;
+    #define ERRCHECK_EVAL_(call, site)                                     \
+        (errcheck_ok_ = ((call) != 0),                                     \
+         __builtin_expect(errcheck_t0_ != 0, 0)                            \
+             ? errcheck_profile_record_(errcheck_t0_, (site), __func__, errcheck_ok_) \
+             : (void)0,                                                    \
+         errcheck_ok_)
+#else
+    #define ERRCHECK_PROFILE_BEGIN_()
+    #define ERRCHECK_EVAL_(call, site) (call)
+#endif
+
+/* ========================================================================= */
+/* Optional: Injection Explorer (POSIX)                                      */
+/* ========================================================================= */
+/* Finds error paths that don't change anything. A baseline run of your
+ * scenario discovers every (site, err) it evaluates; then each site is
+ * failed once, in a fresh run, and the outcome is fingerprinted:
+ *
+ *     static void boot(errcheck_outcome_t *o)       // must start from a clean state
+ *     {
+ *         reset_simulation();
+ *         o->ret    = device_init();
+ *         o->action = g_recovery_action;            // whatever your policy chose
+ *         errcheck_outcome_mix(o, log_buf, log_len);
+ *     }
+ *
+ *     errcheck_explore_result_t res[512];
+ *     errcheck_explorer_t x = { boot, 0, 8, res, 512 };   // 8 forked runs in parallel
+ *     errcheck_explore(&x);
+ *     errcheck_explore_report(&x, stdout);
+ *
+ * Verdicts:
+ *   NO EFFECT   return value, action and output equal the baseline: the
+ *               failure was swallowed, or the error path does nothing
+ *   UNRELATED   the run ends with an error code unrelated to the injected
+ *               one — typically a copy-pasted error flag on the caller's CHECK
+ *
+ * 'related' decides what "unrelated" means; NULL uses the rollup tree when
+ * ERRCHECK_ENABLE_ROLLUPS is on (same node, or one node beneath the other)
+ * and otherwise reports NO EFFECT only. With jobs != 0 every injected run is
+ * a forked child, so a crash is reported as ABORTED instead of ending the
+ * exploration. Sites are told apart by their id: use build-stable site ids.
+ */
+#ifdef ERRCHECK_ENABLE_EXPLORE
+    #ifndef ERRCHECK_ENABLE_INJECTION_PLAN
+        #error "ERRCHECK_ENABLE_EXPLORE requires ERRCHECK_ENABLE_INJECTION_PLAN"
+    #endif
+    #include <stdio.h>
+    #include <string.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/wait.h>
+
+    #ifndef ERRCHECK_EXPLORE_MAX_JOBS
+        #define ERRCHECK_EXPLORE_MAX_JOBS 64
+    #endif
+
+    typedef struct {
+        uint32_t ret;          /* what the scenario's entry point returned */
+        uint32_t last_error;   /* g_last_error afterwards (filled in for you) */
+        uint32_t action;       /* recovery action taken (application-defined) */
+        uint32_t output;       /* observable output, see errcheck_outcome_mix() */
+    } errcheck_outcome_t;
+
+    #define ERRCHECK_EXPLORE_CHANGED      0u
+    #define ERRCHECK_EXPLORE_NO_EFFECT    1u
+    #define ERRCHECK_EXPLORE_UNRELATED    2u
+    #define ERRCHECK_EXPLORE_NOT_REACHED  3u   /* site not evaluated in the injected run */
+    #define ERRCHECK_EXPLORE_ABORTED      4u   /* forked run crashed or exited */
+
+    typedef struct {
+        uint32_t           site;
+        uint32_t           err;
+        errcheck_outcome_t outcome;
+        uint32_t           verdict;
+    } errcheck_explore_result_t;
+
+    typedef struct {
+        void     (*run)(errcheck_outcome_t *out);
+        int      (*related)(uint32_t injected, uint32_t final);
+        uint32_t   jobs;                         /* parallel forked runs; 0 = in-process */
+        errcheck_explore_result_t *result;       /* one per discovered site */
+        uint32_t   max;
+        uint32_t   n;                            /* out: sites discovered */
+        errcheck_outcome_t baseline;             /* out: outcome without injection */
+    } errcheck_explorer_t;
+
+    /* Folds output bytes (log lines, frames sent, ...) into the fingerprint */
+    static inline void errcheck_outcome_mix(errcheck_outcome_t *o, const void *data, uint32_t len)
+    {
+        const uint8_t *b = (const uint8_t *)data;
+        uint32_t h = o->output, i;
+        for (i = 0; i < len; i++) h = (h ^ b[i]) * 16777619u;
+        o->output = h;
+    }
+
+    /* Discovery runs in this process only */
+    static errcheck_explorer_t *errcheck_explore_cur_;
+
+    static inline void errcheck_explore_seen_(uint32_t site, uint32_t err)
+    {
+        errcheck_explorer_t *x = errcheck_explore_cur_;
+        uint32_t i;
+        for (i = 0; i < x->n; i++)
+            if (x->result[i].site == site && x->result[i].err == err) return;
+        if (x->n == x->max) return;
+        x->result[x->n].site = site;
+        x->result[x->n].err  = err;
+        x->n++;
+    }
+
+    static inline int errcheck_explore_related_(const errcheck_explorer_t *x,
+                                                uint32_t injected, uint32_t final)
+    {
+        if (injected == final) return 1;
+        if (x->related) return x->related(injected, final);
+    #ifdef ERRCHECK_ENABLE_ROLLUPS
+        {
+            uint8_t a = errcheck_node_of(injected), b = errcheck_node_of(final), n;
+            for (n = a; ; n = errcheck_node_parent_[n]) {
+                if (n == b) return 1;
+                if (errcheck_node_parent_[n] == n) break;
+            }
+            for (n = b; ; n = errcheck_node_parent_[n]) {
+                if (n == a) return 1;
+                if (errcheck_node_parent_[n] == n) break;
+            }
+            return 0;
+        }
+    #else
+        return 1;
+    #endif
+    }
+
+    /* One scenario run under 'plan'; returns nonzero if the plan's rule matched */
+    static inline int errcheck_explore_once_(const errcheck_explorer_t *x,
+                                             errcheck_inject_plan_t *plan, errcheck_outcome_t *o)
+    {
+        memset(o, 0, sizeof *o);
+        g_last_error = (err_t)0;
+        errcheck_clear();
+        errcheck_inject_publish(plan);
+        x->run(o);
+        errcheck_inject_publish(0);
+        o->last_error = (uint32_t)g_last_error;
+        errcheck_clear();
+        return plan->n == 0 || __atomic_load_n(&plan->rule[0].hits, __ATOMIC_RELAXED) != 0;
+    }
+
+    static inline uint32_t errcheck_explore_verdict_(const errcheck_explorer_t *x,
+                                                     const errcheck_explore_result_t *r, int fired)
+    {
+        const errcheck_outcome_t *o = &r->outcome, *b = &x->baseline;
+        if (!fired) return ERRCHECK_EXPLORE_NOT_REACHED;
+        if (o->ret == b->ret && o->action == b->action && o->output == b->output)
+            return ERRCHECK_EXPLORE_NO_EFFECT;
+        if (!errcheck_explore_related_(x, r->err, o->last_error)) return ERRCHECK_EXPLORE_UNRELATED;
+        return ERRCHECK_EXPLORE_CHANGED;
+    }
+
+    static inline void errcheck_explore_arm_(errcheck_inject_plan_t *plan,
+                                             const errcheck_explore_result_t *r)
+    {
+        memset(plan->rule, 0, sizeof *plan->rule);
+        plan->rule->err   = r->err;
+        plan->rule->site  = r->site;
+        plan->rule->count = 1;                 /* first evaluation fails, later ones pass */
+        plan->cursor      = 0;
+    }
+
+    /* Each site in its own child, at most 'jobs' at a time; results come
+       back over one pipe (records are smaller than PIPE_BUF, so atomic) */
+    static inline void errcheck_explore_forked_(errcheck_explorer_t *x, errcheck_inject_plan_t *plan)
+    {
+        struct { uint32_t index, fired; errcheck_outcome_t o; } rec;
+        pid_t    pid[ERRCHECK_EXPLORE_MAX_JOBS];
+        uint32_t jobs = x->jobs < ERRCHECK_EXPLORE_MAX_JOBS ? x->jobs : ERRCHECK_EXPLORE_MAX_JOBS;
+        uint32_t next = 0, running = 0, k;
+        int      fd[2];
+
+        if (pipe(fd) != 0) return;
+        fcntl(fd[0], F_SETFL, O_NONBLOCK);
+        for (k = 0; k < jobs; k++) pid[k] = 0;
+
+        while (next < x->n || running) {
+            pid_t w;
+            int   st;
+            for (k = 0; k < jobs && next < x->n; k++) {
+                if (pid[k]) continue;
+                errcheck_explore_arm_(plan, &x->result[next]);
+                fflush(0);
+                pid[k] = fork();
+                if (pid[k] == 0) {
+                    close(fd[0]);
+                    rec.index = next;
+                    rec.fired = (uint32_t)errcheck_explore_once_(x, plan, &rec.o);
+                    fflush(0);
+                    _exit(write(fd[1], &rec, sizeof rec) == (ssize_t)sizeof rec ? 0 : 1);
+                }
+                if (pid[k] < 0) { pid[k] = 0; break; }
+                next++;
+                running++;
+            }
+            if (!running) break;                   /* fork failed with nothing to reap */
+            w = waitpid(-1, &st, 0);
+            for (k = 0; k < jobs; k++)
+                if (w > 0 && pid[k] == w) { pid[k] = 0; running--; }
+            while (read(fd[0], &rec, sizeof rec) == (ssize_t)sizeof rec) {
+                errcheck_explore_result_t *r = &x->result[rec.index];
+                r->outcome = rec.o;
+                r->verdict = errcheck_explore_verdict_(x, r, (int)rec.fired);
+            }
+        }
+        close(fd[0]);
+        close(fd[1]);
+    }
+
+    /* Returns the number of sites explored (capped at x->max) */
+    static inline uint32_t errcheck_explore(errcheck_explorer_t *x)
+    {
+        errcheck_inject_rule_t rule;
+        errcheck_inject_plan_t plan;
+        uint32_t i;
+
+        memset(&plan, 0, sizeof plan);
+        plan.seen = errcheck_explore_seen_;
+        x->n = 0;
+        errcheck_explore_cur_ = x;
+        errcheck_explore_once_(x, &plan, &x->baseline);
+        errcheck_explore_cur_ = 0;
+
+        plan.seen = 0;
+        plan.n    = 1;
+        plan.rule = &rule;
+        for (i = 0; i < x->n; i++) x->result[i].verdict = ERRCHECK_EXPLORE_ABORTED;
+
+        if (x->jobs) {
+            errcheck_explore_forked_(x, &plan);
+        } else {
+            for (i = 0; i < x->n; i++) {
+                errcheck_explore_result_t *r = &x->result[i];
+                int fired;
+                errcheck_explore_arm_(&plan, r);
+                fired = errcheck_explore_once_(x, &plan, &r->outcome);
+                r->verdict = errcheck_explore_verdict_(x, r, fired);
+            }
+        }
+        return x->n;
+    }
+
+    /* Lists every flagged site, then a summary line */
+    static inline void errcheck_explore_report(const errcheck_explorer_t *x, FILE *f)
+    {
+        static const char *const name[] = {
+            "changed", "NO EFFECT", "UNRELATED", "not reached", "ABORTED"
+        };
+        uint32_t count[5] = { 0, 0, 0, 0, 0 }, i;
+        for (i = 0; i < x->n; i++) {
+            const errcheck_explore_result_t *r = &x->result[i];
+            count[r->verdict]++;
+            if (r->verdict == ERRCHECK_EXPLORE_CHANGED) continue;
+            fprintf(f, "%-11s site=%u err=%u -> ret=%u last_error=%u action=%u\n",
+                    name[r->verdict], (unsigned)r->site, (unsigned)r->err,
+                    (unsigned)r->outcome.ret, (unsigned)r->outcome.last_error,
+                    (unsigned)r->outcome.action);
+        }
+        fprintf(f, "%u sites: %u changed, %u no effect, %u unrelated, %u not reached, %u aborted\n",
+                (unsigned)x->n, (unsigned)count[0], (unsigned)count[1], (unsigned)count[2],
+                (unsigned)count[3], (unsigned)count[4]);
+    }
+#endif
+
 #endif /* ERRCHECK_H */
@@ -0,0 +1,70 @@
+/**
+ * =============================================================================
+ * examples/embedded_minimal.c
+ * 
+ * Freestanding profile: no <stdio.h>, no printf.
+ * Failures are reported through one user-supplied byte sink (errcheck_putc),
+ * either as short text lines or as compact tokenized records.
+ * 
+ * Build variants:
+ *   gcc -Os embedded_minimal.c -D ERRCHECK_ENABLE_SINK_LOGGING   → "E<site>:<err>"
+ *   gcc -Os embedded_minimal.c -D ERRCHECK_ENABLE_TOKEN_LOGGING  → 7-byte records
+ *   gcc -Os embedded_minimal.c                                   → silent
+ * 
+ * Measure the cost of each variant with tools/size_report.sh
+ * =============================================================================
+ */
+
+#include <stdint.h>
+
+/* -------------------------------------------------------------------------
+ * User-defined error type (declared before errcheck.h so it is used as err_t)
+ * ------------------------------------------------------------------------- */
+typedef enum {
+    ERR_NONE = 0,
+    ERR_POWER,
+    ERR_SENSOR,
+    ERR_RADIO
+} err_t;
+#define ERR_T
+
+#define ERR_FAILURE ((err_t)0xFF)
+
+#include "../errcheck.h"
+
+err_t g_last_error = ERR_NONE;
+
+/* -------------------------------------------------------------------------
+ * Byte sink — on a real target this is one UART/ITM/RTT register write.
+ * Here the host build forwards bytes to fd 1 without touching stdio.
+ * ------------------------------------------------------------------------- */
+#if defined(ERRCHECK_ENABLE_SINK_LOGGING) || defined(ERRCHECK_ENABLE_TOKEN_LOGGING)
+#include <unistd.h>
+void errcheck_putc(char c)
+{
+    (void)write(1, &c, 1);
+}
+#endif
+
+/* -------------------------------------------------------------------------
+ * Fake drivers (volatile so the compiler keeps the checks for measurement)
+ * ------------------------------------------------------------------------- */
+static volatile int s_radio_ok = 0;     // ← Radio intentionally fails
+
+int init_power(void)  { return 1; }
+int init_sensor(void) { return 1; }
+int init_radio(void)  { return s_radio_ok; }
+
+err_t device_init(void)
+{
+    CHECK(init_power(),  ERR_POWER);
+    CHECK(init_sensor(), ERR_SENSOR);
+    CHECK(init_radio(),  ERR_RADIO);    // Fails → record emitted, function returns
+
+    return ERR_NONE;
+}
+
+int main(void)
+{
+    return device_init() == ERR_FAILURE ? (int)g_last_error : 0;
+}
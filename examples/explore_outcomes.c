@@ -0,0 +1,113 @@
+/**
+ * =============================================================================
+ * examples/explore_outcomes.c
+ *
+ * Lets the injection explorer find two classic bugs automatically:
+ *
+ *   - radio_init() is checked with ERR_SENSOR (copy-paste), so an SPI fault
+ *     in the radio surfaces as a sensor problem       → UNRELATED
+ *   - calibrate()'s failure is dropped by its caller  → NO EFFECT
+ *
+ * Build: cc -D_GNU_SOURCE examples/explore_outcomes.c
+ * =============================================================================
+ */
+
+#include <stdio.h>
+
+/* -------------------------------------------------------------------------
+ * User-defined error codes and subsystem tree (defines "related" codes)
+ * ------------------------------------------------------------------------- */
+typedef enum {
+    ERR_NONE = 0,
+    ERR_I2C,
+    ERR_SPI,
+    ERR_SENSOR,
+    ERR_RADIO,
+    ERR_CALIB
+} err_t;
+#define ERR_T
+
+#define ERR_FAILURE ((err_t)0xFF)
+
+#define ERRCHECK_NODES(X)             \
+    X(NODE_BOARD,  NODE_BOARD)        \
+    X(NODE_SENSOR, NODE_BOARD)        \
+    X(NODE_RADIO,  NODE_BOARD)
+
+#define ERRCHECK_CODE_NODES(X)        \
+    X(ERR_I2C,    NODE_SENSOR)        \
+    X(ERR_SENSOR, NODE_SENSOR)        \
+    X(ERR_CALIB,  NODE_SENSOR)        \
+    X(ERR_SPI,    NODE_RADIO)         \
+    X(ERR_RADIO,  NODE_RADIO)
+
+#define ERRCHECK_ENABLE_STABLE_SITE_IDS
+#define ERRCHECK_ENABLE_ROLLUPS
+#define ERRCHECK_ENABLE_INJECTION_PLAN
+#define ERRCHECK_ENABLE_EXPLORE
+#include "../errcheck.h"
+
+err_t                   g_last_error = ERR_NONE;
+uint32_t                g_errcheck_node_self[ERRCHECK_NODE_COUNT];
+uint32_t                g_errcheck_node_total[ERRCHECK_NODE_COUNT];
+errcheck_inject_plan_t *g_errcheck_inject_plan;
+errcheck_readers_t      g_errcheck_plan_readers;
+uint32_t                g_errcheck_thread_tag;
+uint32_t                g_errcheck_scope_mask;
+uint32_t                g_errcheck_coarse_ms;
+
+/* -------------------------------------------------------------------------
+ * Drivers (always succeed; the explorer injects the failures)
+ * ------------------------------------------------------------------------- */
+static int i2c_read(int reg)  { return reg != 0xFF; }
+static int spi_xfer(int byte) { return byte >= 0; }
+
+static int g_mode;              /* 0 = full, 1 = degraded (recovery action) */
+
+err_t calibrate(void)
+{
+    CHECK(i2c_read(0x20), ERR_CALIB);
+    return ERR_NONE;
+}
+
+err_t sensor_init(void)
+{
+    CHECK(i2c_read(0x10), ERR_I2C);
+    calibrate();                                    /* BUG: result ignored */
+    return ERR_NONE;
+}
+
+err_t radio_init(void)
+{
+    CHECK(spi_xfer(0x01), ERR_SPI);
+    CHECK(spi_xfer(0x02), ERR_SPI);
+    return ERR_NONE;
+}
+
+err_t device_init(void)
+{
+    CHECK(sensor_init() == ERR_NONE, ERR_SENSOR);
+    CHECK(radio_init()  == ERR_NONE, ERR_SENSOR);   /* BUG: should be ERR_RADIO */
+    return ERR_NONE;
+}
+
+/* -------------------------------------------------------------------------
+ * Scenario: one boot with the recovery policy, from a clean state
+ * ------------------------------------------------------------------------- */
+static void boot(errcheck_outcome_t *o)
+{
+    g_mode = 0;
+    o->ret = device_init();
+    if (o->ret == ERR_FAILURE && g_last_error == ERR_RADIO) g_mode = 1;   /* run offline */
+    o->action = (uint32_t)g_mode;
+}
+
+int main(void)
+{
+    static errcheck_explore_result_t res[64];
+    errcheck_explorer_t x = { boot, 0, 4, res, 64, 0, { 0, 0, 0, 0 } };
+
+    errcheck_explore(&x);
+    errcheck_explore_report(&x, stdout);
+    return 0;
+}
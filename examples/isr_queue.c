@@ -0,0 +1,77 @@
+/**
+ * =============================================================================
+ * examples/isr_queue.c
+ * 
+ * Interrupt-to-task error reporting without locks. A periodic signal plays
+ * the role of the ADC interrupt: its CHECK_ISR failures are pushed into a
+ * wait-free SPSC queue, and the main loop drains them in batches to the
+ * byte sink. The interrupt never blocks, never formats text.
+ * 
+ *   gcc -D_DEFAULT_SOURCE isr_queue.c -o isr_queue && ./isr_queue
+ * =============================================================================
+ */
+
+#include <stdio.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+/* -------------------------------------------------------------------------
+ * User-defined error codes
+ * ------------------------------------------------------------------------- */
+typedef enum {
+    ERR_NONE = 0,
+    ERR_ADC_RANGE,          // Sample outside the valid window
+    ERR_ADC_OVERRUN         // Previous sample not consumed in time
+} err_t;
+#define ERR_T
+
+#define ERR_FAILURE ((err_t)0xFF)
+
+#define ERRCHECK_ENABLE_SINK_LOGGING
+#define ERRCHECK_ENABLE_ISR_QUEUE
+#define ERRCHECK_QUEUE_CAPACITY 16
+#include "../errcheck.h"
+
+err_t            g_last_error = ERR_NONE;
+errcheck_queue_t g_errcheck_isr_queue;
+
+void errcheck_putc(char c) { putchar(c); }
+
+/* -------------------------------------------------------------------------
+ * "Interrupt" context
+ * ------------------------------------------------------------------------- */
+static volatile sig_atomic_t s_irq_count;
+
+int adc_in_range(void)   { return s_irq_count % 4 != 0; }   // Every 4th sample bad
+int adc_consumed(void)   { return s_irq_count % 7 != 0; }   // Every 7th overruns
+
+void adc_irq_handler(int sig)
+{
+    (void)sig;
+    s_irq_count++;
+    CHECK_ISR(adc_in_range(), ERR_ADC_RANGE);
+    CHECK_ISR(adc_consumed(), ERR_ADC_OVERRUN);
+}
+
+/* -------------------------------------------------------------------------
+ * Main loop: drain whatever the interrupt queued
+ * ------------------------------------------------------------------------- */
+int main(void)
+{
+    struct itimerval tick = { { 0, 1000 }, { 0, 1000 } };   // 1 kHz "IRQ"
+    int loops;
+
+    signal(SIGALRM, adc_irq_handler);
+    setitimer(ITIMER_REAL, &tick, NULL);
+
+    for (loops = 0; loops < 10; loops++) {
+        sig_atomic_t until = s_irq_count + 5;
+        while (s_irq_count < until) pause();                // "Other work"
+        printf("-- main loop %d: %u record(s)\n", loops,
+               (unsigned)errcheck_queue_drain(&g_errcheck_isr_queue));
+    }
+
+    printf("dropped (queue full): %u\n", (unsigned)g_errcheck_isr_queue.dropped);
+    return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * =============================================================================
+ * examples/multiple_domains.c
+ * 
+ * A driver library and the application both use errcheck.h in one binary.
+ * The library declares its own error domain ("net") so its error type,
+ * failure sentinel, last-error state and counters never collide with the
+ * application's err_t / ERR_FAILURE / g_last_error.
+ * =============================================================================
+ */
+
+#include <stdio.h>
+
+/* -------------------------------------------------------------------------
+ * Application error codes (default domain)
+ * ------------------------------------------------------------------------- */
+typedef enum {
+    ERR_NONE = 0,
+    ERR_NETWORK,            // Network stack could not be brought up
+    ERR_STORAGE
+} err_t;
+#define ERR_T
+
+#define ERR_FAILURE ((err_t)0xFF)
+
+#define ERRCHECK_ENABLE_RUNTIME_INJECTION
+#include "../errcheck.h"
+
+err_t g_last_error = ERR_NONE;
+volatile uint8_t g_inject_error_flag = 0;
+
+/* =========================================================================
+ * --- net library (normally net.h / net.c) ---
+ * ========================================================================= */
+enum {
+    NET_OK = 0,
+    NET_ERR_PHY = 0x101,    // 16-bit codes: would not even fit the app's err_t
+    NET_ERR_DHCP
+};
+
+ERRCHECK_DECLARE_DOMAIN(net, uint16_t, 0xFFFF)     // net.h
+ERRCHECK_DEFINE_DOMAIN(net)                        // net.c
+
+static int phy_up(void)       { return 1; }
+static int dhcp_request(void) { return 0; }        // ← Intentional failure
+
+net_err_t net_open(void)
+{
+    CHECK_IN(net, phy_up(),       NET_ERR_PHY);
+    CHECK_IN(net, dhcp_request(), NET_ERR_DHCP);
+    return NET_OK;
+}
+
+/* =========================================================================
+ * --- application ---
+ * ========================================================================= */
+err_t app_init(void)
+{
+    /* The library returns its own sentinel; translate at the boundary */
+    CHECK(net_open() != net_failure(), ERR_NETWORK);
+    return ERR_NONE;
+}
+
+int main(void)
+{
+    if (app_init() == ERR_FAILURE) {
+        printf("App failed: g_last_error = %d (ERR_NETWORK)\n", g_last_error);
+        printf("  caused by net_last_error = 0x%X (NET_ERR_DHCP), net failures = %u\n",
+               net_last_error, (unsigned)net_failure_count);
+    }
+
+    /* Inject into the library domain only — the app's flag is untouched */
+    net_inject_error_flag = NET_ERR_PHY;
+    (void)net_open();
+    printf("Injected: net_last_error = 0x%X (NET_ERR_PHY), net failures = %u\n",
+           net_last_error, (unsigned)net_failure_count);
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * =============================================================================
+ * examples/replay_incident.c
+ *
+ * Record a field incident, turn it into a plan, replay it in the lab:
+ *
+ *   cc -D_GNU_SOURCE examples/replay_incident.c -o replay -lpthread
+ *   ./replay record > field.log              # "field": flaky I2C and SPI
+ *   tools/trace2plan.py field.log > replay.conf
+ *   ./replay replay replay.conf > lab.log    # healthy drivers + the plan
+ *   diff field.log lab.log                   # same records, same order
+ *
+ * The field run has two independent incidents. Each is logged once by the
+ * failing driver check and once more by every frame it propagates through
+ * (E<site>:<err> per frame). On replay only the innermost step is injected;
+ * the outer frames fail by themselves and consume their own steps, so the
+ * plan moves on to the second incident.
+ * =============================================================================
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+/* -------------------------------------------------------------------------
+ * User-defined error codes
+ * ------------------------------------------------------------------------- */
+typedef enum {
+    ERR_NONE = 0,
+    ERR_I2C,
+    ERR_SPI,
+    ERR_SENSOR,
+    ERR_RADIO,
+    ERR_POLL
+} err_t;
+#define ERR_T
+
+#define ERR_FAILURE ((err_t)0xFF)
+
+#define ERRCHECK_ENABLE_STABLE_SITE_IDS
+#define ERRCHECK_ENABLE_SINK_LOGGING
+#define ERRCHECK_ENABLE_INJECTION_PLAN
+#define ERRCHECK_ENABLE_INJECTION_RELOAD      /* errcheck_inject_load() */
+#include "../errcheck.h"
+
+err_t                   g_last_error = ERR_NONE;
+errcheck_inject_plan_t *g_errcheck_inject_plan;
+errcheck_readers_t      g_errcheck_plan_readers;
+uint32_t                g_errcheck_thread_tag;
+uint32_t                g_errcheck_scope_mask;
+uint32_t                g_errcheck_coarse_ms;
+
+void     errcheck_putc(char c) { putchar(c); }
+uint32_t errcheck_time_ms(void) { return 0; }
+void     errcheck_sleep_ms(uint32_t ms) { (void)ms; }   /* no real backoff here */
+
+/* -------------------------------------------------------------------------
+ * Drivers: in the field the I2C bus glitches on cycle 3 and the SPI link is
+ * down for all of cycle 7 (every retry fails); in the lab both are healthy
+ * ------------------------------------------------------------------------- */
+static int g_field;
+static int g_cycle;
+
+static int i2c_read(int reg)  { (void)reg;  return !(g_field && g_cycle == 3); }
+static int spi_xfer(int byte) { (void)byte; return !(g_field && g_cycle == 7); }
+
+err_t sensor_read(void)
+{
+    CHECK(i2c_read(0x10), ERR_I2C);
+    return ERR_NONE;
+}
+
+err_t radio_send(void)
+{
+    CHECK_RETRY(spi_xfer(0x01), ERR_SPI, 3, 10);
+    return ERR_NONE;
+}
+
+err_t device_poll(void)
+{
+    CHECK(sensor_read() == ERR_NONE, ERR_SENSOR);
+    CHECK(radio_send()  == ERR_NONE, ERR_RADIO);
+    return ERR_NONE;
+}
+
+err_t main_cycle(void)
+{
+    CHECK(device_poll() == ERR_NONE, ERR_POLL);
+    return ERR_NONE;
+}
+
+int main(int argc, char **argv)
+{
+    errcheck_inject_plan_t *plan = 0;
+    uint32_t steps = 0;
+
+    if (argc == 2 && !strcmp(argv[1], "record")) {
+        g_field = 1;
+    } else if (argc == 3 && !strcmp(argv[1], "replay")) {
+        if (!errcheck_inject_load(argv[2], &plan)) {
+            fprintf(stderr, "cannot load %s\n", argv[2]);
+            return 1;
+        }
+        steps = plan ? plan->n : 0;
+        errcheck_inject_publish(plan);
+    } else {
+        fprintf(stderr, "usage: %s record | replay <plan>\n", argv[0]);
+        return 2;
+    }
+
+    for (g_cycle = 1; g_cycle <= 10; g_cycle++) {
+        if (main_cycle() != ERR_NONE)
+            fprintf(stderr, "cycle %2d: failed, last error %d\n", g_cycle, g_last_error);
+    }
+
+    if (plan) {
+        fprintf(stderr, "replayed %u of %u steps\n", plan->cursor, steps);
+        errcheck_inject_publish(0);
+        free(plan);
+    }
+    return 0;
+}
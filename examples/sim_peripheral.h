@@ -0,0 +1,126 @@
+/**
+ * =============================================================================
+ * examples/sim_peripheral.h
+ *
+ * Simulated peripherals for exercising fail-fast sequences and recovery
+ * policies without hardware. Each model has a latency distribution, a
+ * failure probability and stuck states with a recovery time; time passes
+ * through ERRCHECK_SLEEP_MS, so with ERRCHECK_ENABLE_VIRTUAL_TIME millions of
+ * init sequences run per second on a workstation, deterministically.
+ *
+ *   static sim_periph_t radio = SIM_PERIPH("radio", 5, 20, 20000);  // 5..20 ms, 2 % fail
+ *   radio.stuck_ppm = 1000;  radio.recovery_ms = 3000;              // 0.1 % lock up for 3 s
+ *
+ *   int init_radio(void) { return sim_periph_call(&radio); }        // 1 = ok, 0 = failed
+ *
+ * Probabilities are parts per million. A model is not thread-safe: give each
+ * thread its own, seeded differently.
+ * =============================================================================
+ */
+
+#ifndef SIM_PERIPHERAL_H
+#define SIM_PERIPHERAL_H
+
+#include <stdint.h>
+#include "../errcheck.h"
+
+typedef struct {
+    const char *name;
+
+    /* Latency: uniform in [min_ms, max_ms], plus tail_ms with tail_ppm */
+    uint32_t    min_ms;
+    uint32_t    max_ms;
+    uint32_t    tail_ppm;
+    uint32_t    tail_ms;
+
+    uint32_t    fail_ppm;       /* transient: this call fails, the next may not */
+    uint32_t    stuck_ppm;      /* lock-up: every call fails ... */
+    uint32_t    recovery_ms;    /* ... until this much time has passed; 0 = until reset */
+    uint32_t    fail_latency_ms;/* latency of a call on a stuck device (timeout) */
+
+    /* State */
+    uint32_t    rng;            /* xorshift32 state; any nonzero seed */
+    uint32_t    stuck;
+    uint32_t    stuck_until;
+
+    /* Statistics */
+    uint32_t    calls;
+    uint32_t    fails;
+    uint32_t    lockups;
+    uint32_t    busy_ms;
+} sim_periph_t;
+
+#define SIM_PERIPH(name, min_ms, max_ms, fail_ppm)                         \
+    { (name), (min_ms), (max_ms), 0, 0, (fail_ppm), 0, 0, 0, 0x9E3779B9u, 0, 0, 0, 0, 0, 0 }
+
+static inline uint32_t sim_rand_(sim_periph_t *p)
+{
+    uint32_t x = p->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return p->rng = x;
+}
+
+/* Nonzero with probability ppm / 1e6 */
+static inline int sim_chance_(sim_periph_t *p, uint32_t ppm)
+{
+    return ppm != 0 && sim_rand_(p) % 1000000u < ppm;
+}
+
+static inline void sim_periph_seed(sim_periph_t *p, uint32_t seed)
+{
+    p->rng = seed ? seed : 0x9E3779B9u;
+}
+
+static inline void sim_periph_wait_(sim_periph_t *p, uint32_t ms)
+{
+    p->busy_ms += ms;
+    if (ms) ERRCHECK_SLEEP_MS(ms);
+}
+
+/* One transaction: waits the sampled latency, then reports 1 (ok) or 0 */
+static inline int sim_periph_call(sim_periph_t *p)
+{
+    uint32_t lat;
+
+    p->calls++;
+    if (p->stuck && p->recovery_ms != 0 && ERRCHECK_DEADLINE_PASSED(p->stuck_until))
+        p->stuck = 0;
+    if (p->stuck) {
+        sim_periph_wait_(p, p->fail_latency_ms);
+        p->fails++;
+        return 0;
+    }
+
+    lat = p->min_ms;
+    if (p->max_ms > p->min_ms) lat += sim_rand_(p) % (p->max_ms - p->min_ms + 1u);
+    if (sim_chance_(p, p->tail_ppm)) lat += p->tail_ms;
+    sim_periph_wait_(p, lat);
+
+    if (sim_chance_(p, p->stuck_ppm)) {
+        p->stuck = 1;
+        p->stuck_until = ERRCHECK_NOW_MS() + p->recovery_ms;
+        p->lockups++;
+        p->fails++;
+        return 0;
+    }
+    if (sim_chance_(p, p->fail_ppm)) {
+        p->fails++;
+        return 0;
+    }
+    return 1;
+}
+
+/* Power-cycle / reset line: clears a lock-up immediately */
+static inline void sim_periph_reset(sim_periph_t *p)
+{
+    p->stuck = 0;
+}
+
+static inline void sim_periph_clear_stats(sim_periph_t *p)
+{
+    p->calls = p->fails = p->lockups = p->busy_ms = 0;
+}
+
+#endif /* SIM_PERIPHERAL_H */
@@ -0,0 +1,83 @@
+/**
+ * =============================================================================
+ * examples/subsystem_rollup.c
+ * 
+ * Hierarchical error rollups: ERR_I2C, ERR_SPI and ERR_UART belong to the
+ * "bus" subsystem, which belongs to the board. Every failure is counted at
+ * its node and rolled up to the root, so a dashboard can start at the board
+ * total and drill down without scanning every error code.
+ * =============================================================================
+ */
+
+#include <stdio.h>
+
+/* -------------------------------------------------------------------------
+ * User-defined error codes
+ * ------------------------------------------------------------------------- */
+typedef enum {
+    ERR_NONE = 0,
+    ERR_I2C,
+    ERR_SPI,
+    ERR_UART,
+    ERR_POWER
+} err_t;
+#define ERR_T
+
+#define ERR_FAILURE ((err_t)0xFF)
+
+/* -------------------------------------------------------------------------
+ * Subsystem tree (root first, parents before children) and code mapping
+ * ------------------------------------------------------------------------- */
+#define ERRCHECK_NODES(X)           \
+    X(NODE_BOARD, NODE_BOARD)       \
+    X(NODE_BUS,   NODE_BOARD)       \
+    X(NODE_POWER, NODE_BOARD)
+
+#define ERRCHECK_CODE_NODES(X)      \
+    X(ERR_I2C,   NODE_BUS)          \
+    X(ERR_SPI,   NODE_BUS)          \
+    X(ERR_UART,  NODE_BUS)          \
+    X(ERR_POWER, NODE_POWER)
+
+#define ERRCHECK_ENABLE_ROLLUPS
+#include "../errcheck.h"
+
+err_t    g_last_error = ERR_NONE;
+uint32_t g_errcheck_node_self[ERRCHECK_NODE_COUNT];
+uint32_t g_errcheck_node_total[ERRCHECK_NODE_COUNT];
+
+/* -------------------------------------------------------------------------
+ * Driver functions (replace with real HAL calls)
+ * ------------------------------------------------------------------------- */
+static int s_tick;
+
+int i2c_read(void)   { return s_tick % 3 != 0; }    // Fails every 3rd call
+int spi_test(void)   { return s_tick % 5 != 0; }    // Fails every 5th call
+int power_good(void) { return 1; }
+
+err_t bus_poll(void)
+{
+    CHECK(power_good(), ERR_POWER);
+    CHECK(i2c_read(),   ERR_I2C);
+    CHECK(spi_test(),   ERR_SPI);
+    return ERR_NONE;
+}
+
+int main(void)
+{
+    uint8_t n;
+
+    for (s_tick = 1; s_tick <= 30; s_tick++) {
+        (void)bus_poll();
+    }
+
+    /* Drill down: board total, then each node with its own and subtree count */
+    printf("%-12s %6s %6s\n", "node", "self", "total");
+    for (n = 0; n < ERRCHECK_NODE_COUNT; n++) {
+        printf("%-12s %6u %6u   (parent: %s)\n", errcheck_node_name(n),
+               (unsigned)errcheck_node_count(n), (unsigned)errcheck_rollup(n),
+               errcheck_node_name(errcheck_node_parent(n)));
+    }
+
+    return 0;
+}
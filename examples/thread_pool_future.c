@@ -0,0 +1,97 @@
+/**
+ * =============================================================================
+ * examples/thread_pool_future.c
+ * 
+ * Cross-thread fail-fast: calibration runs on a worker thread. When one of
+ * its CHECKs fails, the error code and propagation chain travel back through
+ * an errcheck_future_t, and CHECK_FUTURE re-raises the failure in the
+ * submitting thread as if the CHECK had failed there.
+ * 
+ *   gcc -D_GNU_SOURCE thread_pool_future.c -o thread_pool_future -lpthread
+ * =============================================================================
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+
+/* -------------------------------------------------------------------------
+ * User-defined error codes — state is per thread
+ * ------------------------------------------------------------------------- */
+typedef enum {
+    ERR_NONE = 0,
+    ERR_ADC,                // ADC sample out of range
+    ERR_CALIBRATION         // Calibration job failed
+} err_t;
+#define ERR_T
+
+#define ERR_FAILURE  ((err_t)0xFF)
+#define ERRCHECK_TLS _Thread_local
+
+#define ERRCHECK_ENABLE_CHAIN
+#define ERRCHECK_ENABLE_FUTURES
+#include "../errcheck.h"
+
+ERRCHECK_TLS err_t            g_last_error = ERR_NONE;
+ERRCHECK_TLS errcheck_chain_t g_errcheck_chain;
+ERRCHECK_TLS uint32_t         g_errcheck_origin_site;
+uint32_t                      g_errcheck_future_bell;
+
+/* -------------------------------------------------------------------------
+ * Work done on the worker thread
+ * ------------------------------------------------------------------------- */
+int adc_sample_ok(void) { return 0; }   // ← Intentional failure
+
+err_t read_reference(void)
+{
+    CHECK(adc_sample_ok(), ERR_ADC);
+    return ERR_NONE;
+}
+
+err_t calibrate(void)
+{
+    CHECK(read_reference() != ERR_FAILURE, ERR_CALIBRATION);
+    return ERR_NONE;
+}
+
+static void *worker(void *arg)
+{
+    errcheck_future_complete((errcheck_future_t *)arg, calibrate());
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------
+ * Submitting thread: waits and fails fast with the worker's error
+ * ------------------------------------------------------------------------- */
+err_t system_start(void)
+{
+    errcheck_future_t calib;        // Lives on this stack: no allocation
+    pthread_t         t;
+
+    errcheck_future_init(&calib);
+    pthread_create(&t, NULL, worker, &calib);
+    pthread_detach(t);              // The future is the only handshake
+
+    /* ... other start-up work overlaps with calibration here ... */
+
+    CHECK_FUTURE(&calib);           // ← Re-raises ERR_CALIBRATION here
+    return ERR_NONE;
+}
+
+int main(void)
+{
+    uint8_t i;
+
+    if (system_start() == ERR_FAILURE) {
+        printf("Start FAILED: g_last_error = %d (ERR_CALIBRATION), origin site %u\n",
+               g_last_error, (unsigned)g_errcheck_origin_site);
+        printf("Propagation chain (origin first):\n");
+        for (i = 0; i < g_errcheck_chain.depth; i++) {
+            printf("  %-14s site %-4u err %u\n", g_errcheck_chain.frames[i].func,
+                   (unsigned)g_errcheck_chain.frames[i].site,
+                   (unsigned)g_errcheck_chain.frames[i].err);
+        }
+        errcheck_clear();
+    }
+
+    return 0;
+}
@@ -0,0 +1,229 @@
+#!/usr/bin/env python3
+# =============================================================================
+# tools/errgraph.py
+#
+# Static error-propagation graph: which functions CHECK which, the error codes
+# every entry point can end with, and the smallest set of injection sites
+# that reaches all of them.
+#
+#   device_init ──CHECK(ERR_RADIO)──> radio_init ──CHECK(ERR_SPI)──> spi_xfer
+#
+# Injecting spi_xfer's site makes device_init fail with ERR_RADIO (the code
+# the caller's CHECK sets) and root cause ERR_SPI (the innermost frame, as
+# recorded by ERRCHECK_ENABLE_CHAIN). 'return f(...)' passes f's codes through
+# unchanged. For each entry point the tool reports
+#
+#   returns      codes g_last_error can hold when the entry point fails
+#   root causes  codes of every site reachable beneath it
+#   cover        a minimal set of sites whose injection produces every
+#                returned code and every root cause at least once (greedy)
+#
+# and prints each covering site as a ready-to-use plan rule. Entry points are
+# functions nobody else in the scanned tree calls, unless given with --entry.
+#
+# Usage:
+#   tools/errgraph.py src/                        # report for every root
+#   tools/errgraph.py --entry device_init src/
+#   tools/errgraph.py --plan --entry device_init src/ > matrix.conf  # rule per test
+#   tools/errgraph.py --dot src/ | dot -Tsvg > errgraph.svg
+#
+# Site ids are the build-stable ones (tools/site_ids.py); pass --line-ids for
+# builds that use the default __LINE__ ids. Calls are matched by name only:
+# function pointers and same-named static functions are not told apart.
+# =============================================================================
+
+import argparse
+import re
+import sys
+
+from site_ids import (NOT_FUNCTIONS, MACROS, blank_comments_and_directives, scan,
+                      site_id, sources)
+
+IDENT_CALL_RE = re.compile(r"\b([A-Za-z_]\w*)\s*\(")
+ENUM_RE = re.compile(r"\benum\b[^{;]*\{([^}]*)\}")
+DEFINE_RE = re.compile(r"^\s*#\s*define\s+([A-Za-z_]\w*)\s+\(?\s*(?:\(\w+\)\s*)?(0[xX][0-9a-fA-F]+|\d+)[uU]?\s*\)?\s*$", re.M)
+
+
+class Site:
+    def __init__(self, path, line, func, macro, err, text, line_ids):
+        self.path, self.line, self.func, self.macro = path, line, func, macro
+        self.err = "".join(err.split()) or "?"
+        self.id = line if line_ids else site_id(func, err, text)
+        self.callees = [c for c in IDENT_CALL_RE.findall(text)
+                        if c not in NOT_FUNCTIONS and c not in MACROS]
+
+    def where(self):
+        return "%s:%d" % (self.path, self.line)
+
+
+def build(paths, line_ids):
+    """Returns {function: (sites, pass-through callees)}."""
+    funcs = {}
+    for path in sources(paths):
+        for line, func, macro, err, text in scan(path, returns=True):
+            sites, passes = funcs.setdefault(func, ([], set()))
+            if macro == "return":
+                passes.add(text)
+            else:
+                sites.append(Site(path, line, func, macro, err, text, line_ids))
+    return funcs
+
+
+def code_values(paths):
+    """Numeric values of enum constants and '#define NAME <int>' in the tree,
+    so plan rules can be written with the numbers the parser expects."""
+    values = {}
+    for path in sources(paths):
+        with open(path, encoding="utf-8", errors="replace") as f:
+            raw = f.read()
+        for name, num in DEFINE_RE.findall(raw):
+            values.setdefault(name, int(num, 0))
+        for body in ENUM_RE.findall(blank_comments_and_directives(raw)):
+            nxt = 0
+            for item in body.split(","):
+                m = re.match(r"\s*([A-Za-z_]\w*)\s*(?:=\s*(0[xX][0-9a-fA-F]+|-?\d+)[uU]?)?\s*$", item)
+                if not m:
+                    if item.strip():
+                        break           # non-literal initialiser: stop counting
+                    continue
+                if m.group(2):
+                    nxt = int(m.group(2), 0)
+                values.setdefault(m.group(1), nxt)
+                nxt += 1
+    return values
+
+
+class Graph:
+    def __init__(self, funcs):
+        self.funcs = funcs
+        self.reach_memo = {}
+
+    def edges(self, func):
+        """(site or None, callee) for every known callee of 'func'."""
+        sites, passes = self.funcs.get(func, ((), ()))
+        for s in sites:
+            for c in s.callees:
+                if c in self.funcs and c != func:
+                    yield s, c
+        for c in sorted(passes):
+            if c in self.funcs and c != func:
+                yield None, c
+
+    def reach(self, func, stack=()):
+        """Every site at or beneath 'func' (cycles are cut)."""
+        if func in self.reach_memo:
+            return self.reach_memo[func]
+        if func in stack:
+            return set()
+        out = set(self.funcs.get(func, ((), ()))[0])
+        for _, c in self.edges(func):
+            out |= self.reach(c, stack + (func,))
+        if not stack:
+            self.reach_memo[func] = out
+        return out
+
+    def returned(self, func, target, stack=()):
+        """Codes 'func' fails with when 'target' is injected."""
+        if func in stack:
+            return set()
+        sites = self.funcs.get(func, ((), ()))[0]
+        if target in sites:
+            return {target.err}
+        out = set()
+        for s, c in self.edges(func):
+            if target in self.reach(c, stack + (func,)):
+                out |= {s.err} if s is not None else self.returned(c, target, stack + (func,))
+        return out
+
+    def entry_points(self):
+        called = {c for f in self.funcs for _, c in self.edges(f)}
+        return sorted(f for f in self.funcs if f not in called)
+
+    def cover(self, func):
+        """Greedy minimal set of sites covering every returned code and root cause."""
+        effects = {}
+        for t in self.reach(func):
+            effects[t] = ({("returns", c) for c in self.returned(func, t)} |
+                          {("root", t.err)})
+        todo = set().union(*effects.values()) if effects else set()
+        chosen = []
+        while todo:
+            best = max(sorted(effects, key=lambda t: (t.path, t.line)),
+                       key=lambda t: len(effects[t] & todo))
+            chosen.append(best)
+            todo -= effects[best]
+        return chosen, effects
+
+
+def report(g, entries, out):
+    for e in entries:
+        chosen, effects = g.cover(e)
+        returns = sorted({c for t in effects for k, c in effects[t] if k == "returns"})
+        roots = sorted({t.err for t in effects})
+        out.write("%s\n" % e)
+        out.write("  returns      %s\n" % " ".join(returns))
+        out.write("  root causes  %s\n" % " ".join(roots))
+        out.write("  cover        %d of %d sites\n" % (len(chosen), len(effects)))
+        for t in chosen:
+            ret = sorted(c for k, c in effects[t] if k == "returns")
+            out.write("    site=%-10u err=%-14s %-24s %s() -> %s\n"
+                      % (t.id, t.err, t.where(), t.func, "/".join(ret)))
+        out.write("\n")
+
+
+def plan(g, entries, values, out):
+    for e in entries:
+        chosen, effects = g.cover(e)
+        out.write("# %s: %d test(s) cover every returned code and root cause;\n"
+                  "# load one rule per run\n" % (e, len(chosen)))
+        for t in chosen:
+            if t.err in values:
+                out.write("err=%d site=%u count=1   # %s %s %s()\n"
+                          % (values[t.err], t.id, t.err, t.where(), t.func))
+            else:
+                out.write("# err=%s site=%u count=1   # %s %s(): value unknown, fill in\n"
+                          % (t.err, t.id, t.where(), t.func))
+
+
+def dot(g, out):
+    out.write("digraph errgraph {\n  rankdir=LR; node [shape=box, fontname=monospace];\n")
+    for f in sorted(g.funcs):
+        for s, c in g.edges(f):
+            label = s.err if s is not None else "return"
+            out.write('  "%s" -> "%s" [label="%s"];\n' % (f, c, label))
+        for s in g.funcs[f][0]:
+            if not any(c in g.funcs for c in s.callees):
+                leaf = "%s@%d" % (f, s.line)
+                out.write('  "%s" [shape=plaintext, label="%s"];\n' % (leaf, " ".join(s.callees) or s.macro))
+                out.write('  "%s" -> "%s" [label="%s", style=dashed];\n' % (f, leaf, s.err))
+    out.write("}\n")
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Static error-propagation graph.")
+    ap.add_argument("paths", nargs="+", help="source files or directories")
+    ap.add_argument("--entry", action="append", help="entry point (repeatable)")
+    ap.add_argument("--plan", action="store_true",
+                    help="print the covering sites as injection plan rules")
+    ap.add_argument("--dot", action="store_true", help="print a Graphviz graph")
+    ap.add_argument("--line-ids", action="store_true",
+                    help="use __LINE__ site ids instead of build-stable ones")
+    args = ap.parse_args()
+
+    g = Graph(build(args.paths, args.line_ids))
+    entries = args.entry or g.entry_points()
+    unknown = [e for e in entries if e not in g.funcs]
+    if unknown:
+        sys.exit("errgraph: no CHECK sites in %s" % ", ".join(unknown))
+
+    if args.dot:
+        dot(g, sys.stdout)
+    elif args.plan:
+        plan(g, entries, code_values(args.paths), sys.stdout)
+    else:
+        report(g, entries, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+# =============================================================================
+# tools/site_ids.py
+#
+# Computes the build-stable site id of every CHECK-family site in a source
+# tree, exactly as ERRCHECK_ENABLE_STABLE_SITE_IDS does at compile time:
+#
+#   FNV-1a 32 over  function \x1F error \x1F site text
+#
+# with all whitespace removed and 0 mapped to 1. The site text is every macro
+# argument except the error code and the control arguments (retval, retry
+# limits), joined by ','. The function is
+# __func__: the unqualified name for C++ members, "operator()" in lambdas.
+#
+# Default output is a report; the exit status is 1 when two different sites
+# hash to the same id (rename one, or change its error code). Identical
+# checks in the same function share an id and are listed as warnings.
+#
+# Usage:
+#   tools/site_ids.py src/                   # collision report
+#   tools/site_ids.py --map src/ > sites.tsv # id<TAB>file:line<TAB>function
+#
+# Use the map to decode token/sink traces and to pick sites for plan rules.
+# Sites written inside #define bodies are skipped: their id depends on where
+# the macro is expanded.
+# =============================================================================
+
+import argparse
+import os
+import re
+import sys
+
+FNV_BASIS = 2166136261
+FNV_PRIME = 16777619
+WHITESPACE = b" \t\n\r\v\f"
+EXTENSIONS = (".c", ".h", ".cc", ".cpp", ".cxx", ".hh", ".hpp", ".hxx")
+
+# macro -> (argument roles); 's' site text, 'e' error code, 'r' control (not hashed)
+MACROS = {
+    "CHECK":            "se",
+    "CHECK_RET":        "ser",
+    "CHECK_VOID":       "se",
+    "CHECK_SAME":       "s",
+    "CHECK_PTR":        "se",
+    "CHECK_ERRNO":      "se",
+    "CHECK_BOOL":       "se",
+    "CHECK_STATUS":     "sse",
+    "CHECK_T":          "se",
+    "CHECK_ASSIGN":     "sse",
+    "CHECK_ASSIGN_NOT": "ssse",
+    "CHECK_RETRY":      "serr",
+    "CHECK_LEVEL":      "rse",
+    "CHECK_LEVEL_RET":  "rser",
+    "CHECK_LEVEL_VOID": "rse",
+    "CHECK_ISR":        "se",
+    "CHECK_ISR_RET":    "ser",
+    "CHECK_FUTURE":     "s",
+    "CHECK_FUTURE_RET": "sr",
+    "RETURN_ERR":       "e",
+    "RETURN_ERR_RET":   "er",
+    "RETURN_ERR_VOID":  "e",
+    "RETURN_ERR_ISR":   "e",
+}
+FIXED_ERR = {"CHECK_SAME": "g_current_error_group"}
+
+MACRO_RE = re.compile(r"\b(" + "|".join(sorted(MACROS, key=len, reverse=True)) + r")\s*\(")
+CALL_RE = re.compile(r"(~?[A-Za-z_]\w*)\s*\(")
+RETURN_CALL_RE = re.compile(r"return\s+([A-Za-z_]\w*)\s*\(")
+NOT_FUNCTIONS = {"if", "for", "while", "switch", "return", "sizeof", "catch",
+                 "__attribute__", "__declspec", "alignas", "decltype", "noexcept"}
+
+
+def fnv(text, h):
+    for c in text.encode():
+        if c not in WHITESPACE:
+            h = ((h ^ c) * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def site_id(func, err, text):
+    h = fnv(func, FNV_BASIS)
+    h = fnv(err, ((h ^ 0x1F) * FNV_PRIME) & 0xFFFFFFFF)
+    h = fnv(text, ((h ^ 0x1F) * FNV_PRIME) & 0xFFFFFFFF)
+    return h or 1
+
+
+def blank_comments_and_directives(src):
+    """Replaces comments and preprocessor lines with spaces, keeping line
+    numbers and string/char literals intact."""
+    out = list(src)
+    i, n, bol = 0, len(src), True
+    while i < n:
+        c = src[i]
+        if bol and c == "#":
+            while i < n and src[i] != "\n":
+                if src[i] == "\\" and i + 1 < n and src[i + 1] == "\n":
+                    out[i] = " "
+                    i += 2
+                    continue
+                out[i] = " "
+                i += 1
+            continue
+        if c == "\n":
+            bol = True
+            i += 1
+            continue
+        if c in " \t":
+            i += 1
+            continue
+        bol = False
+        if src.startswith("//", i):
+            while i < n and src[i] != "\n":
+                out[i] = " "
+                i += 1
+        elif src.startswith("/*", i):
+            end = src.find("*/", i + 2)
+            end = n if end < 0 else end + 2
+            for k in range(i, end):
+                if out[k] != "\n":
+                    out[k] = " "
+            i = end
+        elif c in "\"'":
+            i += 1
+            while i < n and src[i] != c:
+                i += 2 if src[i] == "\\" else 1
+            i += 1
+        else:
+            i += 1
+    return "".join(out)
+
+
+def split_args(src, i):
+    """Splits the macro arguments starting after '(' at src[i-1]; returns
+    (args, index after ')')."""
+    args, depth, start = [], 0, i
+    while i < len(src):
+        c = src[i]
+        if c in "\"'":
+            i += 1
+            while i < len(src) and src[i] != c:
+                i += 2 if src[i] == "\\" else 1
+        elif c in "([{":
+            depth += 1
+        elif c in ")]}":
+            if depth == 0:
+                args.append(src[start:i].strip())
+                return args, i + 1
+            depth -= 1
+        elif c == "," and depth == 0:
+            args.append(src[start:i].strip())
+            start = i + 1
+        i += 1
+    return None, i
+
+
+def function_name(header):
+    """Name declared by the text between the previous statement and '{'."""
+    for m in CALL_RE.finditer(header):
+        if header.count("(", 0, m.start()) != header.count(")", 0, m.start()):
+            continue
+        if m.group(1) not in NOT_FUNCTIONS:
+            return m.group(1)
+    return None
+
+
+def scan(path, returns=False):
+    """Yields (line, function, macro, err_text, site_text) per site. With
+    'returns', also yields (line, function, "return", "", callee) for every
+    'return callee(...)' that passes a callee's result through unchanged."""
+    with open(path, encoding="utf-8", errors="replace") as f:
+        src = blank_comments_and_directives(f.read())
+
+    # stack of open braces; each entry is the function name or None
+    stack, func, boundary, i = [], None, 0, 0
+    while i < len(src):
+        c = src[i]
+        if c in "\"'":
+            i += 1
+            while i < len(src) and src[i] != c:
+                i += 2 if src[i] == "\\" else 1
+            i += 1
+            continue
+        if c == "{":
+            name = None
+            if func is None:
+                name = function_name(src[boundary:i])
+            elif re.search(r"\]\s*(\([^)]*\))?[^;{}()]*$", src[boundary:i]):
+                name = "operator()"                       # C++ lambda body
+            stack.append((name, func))
+            if name:
+                func = name
+            boundary = i + 1
+        elif c == "}":
+            if stack:
+                _, func = stack.pop()
+            boundary = i + 1
+        elif c == ";":
+            boundary = i + 1
+        elif func is not None and (c.isalpha() or c == "_"):
+            m = MACRO_RE.match(src, i)
+            if m and (i == 0 or not (src[i - 1].isalnum() or src[i - 1] == "_")):
+                macro = m.group(1)
+                args, end = split_args(src, m.end())
+                if args is not None and len(args) == len(MACROS[macro]):
+                    roles = MACROS[macro]
+                    text = ",".join(a for a, r in zip(args, roles) if r == "s")
+                    err = FIXED_ERR.get(macro, "")
+                    for a, r in zip(args, roles):
+                        if r == "e":
+                            err = a
+                    yield src.count("\n", 0, i) + 1, func, macro, err, text
+                    i = end
+                    continue
+            if returns and src.startswith("return", i) and not (i and src[i - 1].isalnum()):
+                m = RETURN_CALL_RE.match(src, i)
+                if m and m.group(1) not in NOT_FUNCTIONS:
+                    args, end = split_args(src, m.end())
+                    if args is not None and re.match(r"\s*;", src[end:]):
+                        yield src.count("\n", 0, i) + 1, func, "return", "", m.group(1)
+            while i < len(src) and (src[i].isalnum() or src[i] == "_"):
+                i += 1
+            continue
+        i += 1
+
+
+def sources(paths):
+    for p in paths:
+        if os.path.isdir(p):
+            for root, _, files in os.walk(p):
+                for name in sorted(files):
+                    if name.endswith(EXTENSIONS):
+                        yield os.path.join(root, name)
+        else:
+            yield p
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Build-stable CHECK site ids.")
+    ap.add_argument("paths", nargs="+", help="source files or directories")
+    ap.add_argument("--map", action="store_true",
+                    help="print id<TAB>file:line<TAB>function for every site")
+    args = ap.parse_args()
+
+    by_id = {}
+    for path in sources(args.paths):
+        for line, func, macro, err, text in scan(path):
+            sid = site_id(func, err, text)
+            by_id.setdefault(sid, []).append((path, line, func, macro, err, text))
+
+    if args.map:
+        for sid in sorted(by_id):
+            for path, line, func, *_ in by_id[sid]:
+                print("%u\t%s:%d\t%s" % (sid, path, line, func))
+
+    collisions = 0
+    for sid, sites in sorted(by_id.items()):
+        if len(sites) < 2:
+            continue
+        keys = {(s[2], "".join(s[4].split()), "".join(s[5].split())) for s in sites}
+        kind = "collision" if len(keys) > 1 else "duplicate"
+        collisions += kind == "collision"
+        print("%s: id %u shared by" % (kind, sid), file=sys.stderr)
+        for path, line, func, macro, _, _ in sites:
+            print("    %s:%d  %s() %s" % (path, line, func, macro), file=sys.stderr)
+
+    if not args.map:
+        print("%d sites, %d ids, %d collisions" %
+              (sum(len(s) for s in by_id.values()), len(by_id), collisions))
+    return 1 if collisions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,50 @@
+#!/bin/sh
+# =============================================================================
+# tools/size_report.sh
+#
+# Prints .text/.rodata of examples/embedded_minimal.c for every reporting
+# profile so the error subsystem can be held to a fixed flash budget.
+#
+# Usage:
+#   tools/size_report.sh                     # host gcc
+#   CC=arm-none-eabi-gcc CFLAGS="-mcpu=cortex-m0 -mthumb" tools/size_report.sh
+#   BUDGET=512 tools/size_report.sh          # fail if any profile grows beyond
+#                                            # BUDGET bytes (.text + .rodata)
+#                                            # over the silent baseline
+# =============================================================================
+
+set -e
+
+CC=${CC:-gcc}
+SIZE=${SIZE:-size}
+CFLAGS=${CFLAGS:-}
+SRC="$(dirname "$0")/../examples/embedded_minimal.c"
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+measure() {
+    # Sum every .text* / .rodata* section of the object (-ffunction-sections)
+    $CC -Os -ffunction-sections -fdata-sections $CFLAGS $2 -c "$SRC" -o "$TMP/$1.o"
+    $SIZE -A "$TMP/$1.o" | awk -v name="$1" '
+        $1 ~ /^\.text/   { text += $2 }
+        $1 ~ /^\.rodata/ { ro   += $2 }
+        END { printf "%-10s %8d %8d %8d\n", name, text, ro, text + ro }'
+}
+
+printf "%-10s %8s %8s %8s\n" profile .text .rodata total
+BASE=$(measure silent "")
+echo "$BASE"
+BASE_TOTAL=$(echo "$BASE" | awk '{ print $4 }')
+
+for p in "sink -DERRCHECK_ENABLE_SINK_LOGGING" \
+         "token -DERRCHECK_ENABLE_TOKEN_LOGGING"; do
+    LINE=$(measure $p)
+    echo "$LINE"
+    if [ -n "$BUDGET" ]; then
+        TOTAL=$(echo "$LINE" | awk '{ print $4 }')
+        if [ $((TOTAL - BASE_TOTAL)) -gt "$BUDGET" ]; then
+            echo "error: ${p%% *} exceeds budget ($((TOTAL - BASE_TOTAL)) > $BUDGET bytes)" >&2
+            exit 1
+        fi
+    fi
+done
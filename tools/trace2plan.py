@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+# =============================================================================
+# tools/trace2plan.py
+#
+# Turns a recorded field failure sequence into a runtime injection plan that
+# replays the same failures, in the same order, against a lab build.
+#
+# Input (auto-detected):
+#   * token stream from ERRCHECK_ENABLE_TOKEN_LOGGING (binary 0xEC / 0xED)
+#   * text from ERRCHECK_ENABLE_SINK_LOGGING, one "E<site>:<err>[x<count>]"
+#     per line, optionally prefixed by a millisecond timestamp
+#     ("12873 E118:2") as added by most log collectors
+#
+# Output: a plan file for ERRCHECK_ENABLE_INJECTION_RELOAD using 'seq' rules —
+# each step fires once, only after the previous one, so the sequence replays
+# at full speed. Recorded relative timing is kept as a comment per step.
+#
+# Usage:
+#   tools/trace2plan.py field.log > replay.conf
+#   tools/trace2plan.py --max 50 --skip-repeats blackbox.bin > replay.conf
+#
+# Site ids must mean the same CHECK in the field and lab builds; use the
+# same source revision or build-stable site ids.
+# =============================================================================
+
+import argparse
+import re
+import struct
+import sys
+
+TOKEN_SYNC = 0xEC
+TOKEN_SYNC_COUNT = 0xED
+TEXT_RE = re.compile(r"^\s*(?:(\d+)\s+)?E(\d+):(\d+)(?:x(\d+))?\s*$")
+
+
+def parse_tokens(data):
+    """Yields (time_ms, site, err, count) from a binary token stream."""
+    i = 0
+    while i < len(data):
+        sync = data[i]
+        if sync == TOKEN_SYNC and i + 7 <= len(data):
+            site, err = struct.unpack_from("<IH", data, i + 1)
+            yield None, site, err, 1
+            i += 7
+        elif sync == TOKEN_SYNC_COUNT and i + 11 <= len(data):
+            site, err, count = struct.unpack_from("<IHI", data, i + 1)
+            yield None, site, err, count
+            i += 11
+        else:
+            i += 1  # resynchronise on garbage / truncated records
+
+
+def parse_text(text):
+    """Yields (time_ms, site, err, count) from sink-logging text lines."""
+    for line in text.splitlines():
+        m = TEXT_RE.match(line)
+        if not m:
+            continue
+        t, site, err, count = m.groups()
+        yield (int(t) if t else None), int(site), int(err), int(count or 1)
+
+
+def load(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:1] in (bytes([TOKEN_SYNC]), bytes([TOKEN_SYNC_COUNT])):
+        return list(parse_tokens(data))
+    return list(parse_text(data.decode("utf-8", "replace")))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0] if __doc__ else None)
+    ap.add_argument("trace", help="recorded token stream or text log ('-' = stdin)")
+    ap.add_argument("--max", type=int, default=256,
+                    help="stop after this many steps (ERRCHECK_RELOAD_MAX_RULES)")
+    ap.add_argument("--skip-repeats", action="store_true",
+                    help="collapse back-to-back identical failures into one step")
+    args = ap.parse_args()
+
+    if args.trace == "-":
+        records = list(parse_text(sys.stdin.read()))
+    else:
+        records = load(args.trace)
+
+    steps = []
+    for t, site, err, count in records:
+        for _ in range(count):
+            if args.skip_repeats and steps and steps[-1][1:] == (site, err):
+                continue
+            steps.append((t, site, err))
+
+    if len(steps) > args.max:
+        print(f"trace2plan: truncated {len(steps)} steps to {args.max}", file=sys.stderr)
+        steps = steps[: args.max]
+
+    t0 = next((t for t, _, _ in steps if t is not None), None)
+    print(f"# replay plan: {len(steps)} step(s) from {args.trace}")
+    for seq, (t, site, err) in enumerate(steps, 1):
+        when = f"   # +{t - t0} ms" if t is not None and t0 is not None else ""
+        print(f"err={err} site={site} seq={seq}{when}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())